@@ -9,17 +9,35 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
+#include <new>
+#include <array>
 #include <tuple>
+#include <mutex>
 #include <memory>
 #include <vector>
 #include <limits>
+#include <thread>
 #include <utility>
 #include <iterator>
 #include <stdexcept>
 #include <algorithm>
 #include <functional>
 #include <type_traits>
+#include <condition_variable>
+
+// define ECS_HPP_ENABLE_STATS before including this header to compile in
+// the hot-path counters behind registry::stats(), registry::reset_stats()
+// and feature::system_times(); without it the counters do not exist and
+// the accessors return empty snapshots
+
+#if defined(ECS_HPP_ENABLE_STATS)
+#  include <chrono>
+#  define ECS_HPP_STATS_INC(counter) (void)(++(counter))
+#else
+#  define ECS_HPP_STATS_INC(counter) (void)0
+#endif
 
 // -----------------------------------------------------------------------------
 //
@@ -38,6 +56,7 @@ namespace ecs_hpp
     class const_component;
 
     class prototype;
+    class baked_prototype;
 
     template < typename E >
     class after;
@@ -66,6 +85,21 @@ namespace ecs_hpp
 
     template < typename... Ts >
     class aspect;
+    template < typename... Ts >
+    class compiled_aspect;
+
+    template < typename... Ts >
+    class view;
+
+    template < typename T >
+    class raw_view;
+    template < typename T >
+    class const_raw_view;
+
+    template < typename... Ts >
+    class group;
+
+    class command_buffer;
 
     class entity_filler;
     class registry_filler;
@@ -94,6 +128,36 @@ namespace ecs_hpp
         "ecs_hpp (invalid entity id index and version bits)");
 }
 
+namespace ecs_hpp
+{
+    // component storage policy tags:
+    //
+    // - unordered_storage_policy (the default) removes components with
+    //   swap-and-pop, so iteration order depends on the mutation history
+    //
+    // - stable_storage_policy removes components by shifting the dense
+    //   arrays, keeping iteration in component creation order at the
+    //   cost of linear removals
+
+    struct unordered_storage_policy final {};
+    struct stable_storage_policy final {};
+
+    // specialize to choose a policy for a concrete component type:
+    //
+    //   template <>
+    //   struct component_storage_policy<movement_c> {
+    //       using type = ecs_hpp::stable_storage_policy;
+    //   };
+
+    template < typename T >
+    struct component_storage_policy {
+        using type = unordered_storage_policy;
+    };
+
+    template < typename T >
+    using component_storage_policy_t = typename component_storage_policy<T>::type;
+}
+
 // -----------------------------------------------------------------------------
 //
 // utilities
@@ -352,11 +416,12 @@ namespace ecs_hpp
     namespace detail
     {
         template < typename T
-                 , typename Indexer = sparse_indexer<T> >
+                 , typename Indexer = sparse_indexer<T>
+                 , typename Allocator = std::allocator<T> >
         class sparse_set final {
         public:
-            using iterator = typename std::vector<T>::iterator;
-            using const_iterator = typename std::vector<T>::const_iterator;
+            using iterator = typename std::vector<T, Allocator>::iterator;
+            using const_iterator = typename std::vector<T, Allocator>::const_iterator;
         public:
             iterator begin() noexcept {
                 return dense_.begin();
@@ -385,6 +450,13 @@ namespace ecs_hpp
             sparse_set(const Indexer& indexer = Indexer())
             : indexer_(indexer) {}
 
+            explicit sparse_set(
+                const Allocator& alloc,
+                const Indexer& indexer = Indexer())
+            : indexer_(indexer)
+            , dense_(alloc)
+            , sparse_(page_allocator(alloc)) {}
+
             sparse_set(const sparse_set& other) = default;
             sparse_set& operator=(const sparse_set& other) = default;
 
@@ -402,48 +474,102 @@ namespace ecs_hpp
                 if ( has(v) ) {
                     return false;
                 }
-                const std::size_t vi = indexer_(v);
-                if ( vi >= sparse_.size() ) {
-                    sparse_.resize(next_capacity_size(
-                        sparse_.size(), vi + 1u, sparse_.max_size()));
-                }
+                assert(dense_.size() < std::numeric_limits<slot_index>::max());
+                slot_index& slot = ensure_slot_(indexer_(v));
                 dense_.push_back(std::forward<UT>(v));
-                sparse_[vi] = dense_.size() - 1u;
+                slot = static_cast<slot_index>(dense_.size() - 1u);
                 return true;
             }
 
+            // the values must not be in the set yet;
+            // keeps the already inserted prefix on exceptions
+            template < typename Iterator >
+            void insert_range(Iterator first, Iterator last) {
+                const auto count = std::distance(first, last);
+                dense_.reserve(dense_.size() + static_cast<std::size_t>(count));
+                for ( ; first != last; ++first ) {
+                    assert(!has(*first));
+                    assert(dense_.size() < std::numeric_limits<slot_index>::max());
+                    slot_index& slot = ensure_slot_(indexer_(*first));
+                    dense_.push_back(*first);
+                    slot = static_cast<slot_index>(dense_.size() - 1u);
+                }
+            }
+
             bool unordered_erase(const T& v) noexcept {
                 if ( !has(v) ) {
                     return false;
                 }
-                const std::size_t vi = indexer_(v);
-                const std::size_t dense_index = sparse_[vi];
+                const std::size_t dense_index = *find_slot_(indexer_(v));
                 if ( dense_index != dense_.size() - 1 ) {
                     using std::swap;
                     swap(dense_[dense_index], dense_.back());
-                    sparse_[indexer_(dense_[dense_index])] = dense_index;
+                    *find_slot_(indexer_(dense_[dense_index])) =
+                        static_cast<slot_index>(dense_index);
+                }
+                dense_.pop_back();
+                return true;
+            }
+
+            bool ordered_erase(const T& v) noexcept {
+                if ( !has(v) ) {
+                    return false;
+                }
+                const std::size_t dense_index = *find_slot_(indexer_(v));
+                for ( std::size_t i = dense_index + 1u; i < dense_.size(); ++i ) {
+                    dense_[i - 1u] = std::move(dense_[i]);
+                    *find_slot_(indexer_(dense_[i - 1u])) =
+                        static_cast<slot_index>(i - 1u);
                 }
                 dense_.pop_back();
                 return true;
             }
 
+            void swap_dense(std::size_t l, std::size_t r) noexcept {
+                assert(l < dense_.size() && r < dense_.size());
+                if ( l == r ) {
+                    return;
+                }
+                using std::swap;
+                swap(*find_slot_(indexer_(dense_[l])),
+                     *find_slot_(indexer_(dense_[r])));
+                swap(dense_[l], dense_[r]);
+            }
+
             void clear() noexcept {
                 dense_.clear();
             }
 
+            void reserve(std::size_t size) {
+                dense_.reserve(size);
+            }
+
+            std::size_t capacity() const noexcept {
+                return dense_.capacity();
+            }
+
             bool has(const T& v) const noexcept {
-                const std::size_t vi = indexer_(v);
-                return vi < sparse_.size()
-                    && sparse_[vi] < dense_.size()
-                    && dense_[sparse_[vi]] == v;
+                const slot_index* slot = find_slot_(indexer_(v));
+                return slot
+                    && *slot < dense_.size()
+                    && dense_[*slot] == v;
             }
 
             const_iterator find(const T& v) const noexcept {
                 return has(v)
-                    ? begin() + sparse_[indexer_(v)]
+                    ? begin() + *find_slot_(indexer_(v))
                     : end();
             }
 
+            const T& at(std::size_t dense_index) const noexcept {
+                assert(dense_index < dense_.size());
+                return dense_[dense_index];
+            }
+
+            const T* data() const noexcept {
+                return dense_.data();
+            }
+
             std::size_t get_dense_index(const T& v) const {
                 const auto p = find_dense_index(v);
                 if ( p.second ) {
@@ -454,7 +580,7 @@ namespace ecs_hpp
 
             std::pair<std::size_t,bool> find_dense_index(const T& v) const noexcept {
                 return has(v)
-                    ? std::make_pair(sparse_[indexer_(v)], true)
+                    ? std::make_pair(std::size_t(*find_slot_(indexer_(v))), true)
                     : std::make_pair(std::size_t(-1), false);
             }
 
@@ -467,20 +593,64 @@ namespace ecs_hpp
             }
 
             std::size_t memory_usage() const noexcept {
+                std::size_t pages_usage = 0u;
+                for ( const sparse_page& page : sparse_ ) {
+                    if ( !page.empty() ) {
+                        pages_usage += sparse_page_size * sizeof(slot_index);
+                    }
+                }
                 return dense_.capacity() * sizeof(dense_[0])
-                    + sparse_.capacity() * sizeof(sparse_[0]);
+                    + sparse_.capacity() * sizeof(sparse_[0])
+                    + pages_usage;
+            }
+        private:
+            using slot_index = std::uint32_t;
+
+            using slot_allocator = typename std::allocator_traits<Allocator>::
+                template rebind_alloc<slot_index>;
+            using sparse_page = std::vector<slot_index, slot_allocator>;
+            using page_allocator = typename std::allocator_traits<Allocator>::
+                template rebind_alloc<sparse_page>;
+
+            static constexpr std::size_t sparse_page_size = 4096u;
+
+            const slot_index* find_slot_(std::size_t vi) const noexcept {
+                const std::size_t page_index = vi / sparse_page_size;
+                return page_index < sparse_.size() && !sparse_[page_index].empty()
+                    ? sparse_[page_index].data() + vi % sparse_page_size
+                    : nullptr;
+            }
+
+            slot_index* find_slot_(std::size_t vi) noexcept {
+                return const_cast<slot_index*>(
+                    std::as_const(*this).find_slot_(vi));
+            }
+
+            slot_index& ensure_slot_(std::size_t vi) {
+                const std::size_t page_index = vi / sparse_page_size;
+                if ( page_index >= sparse_.size() ) {
+                    sparse_.resize(
+                        page_index + 1u,
+                        sparse_page(slot_allocator(dense_.get_allocator())));
+                }
+                sparse_page& page = sparse_[page_index];
+                if ( page.empty() ) {
+                    page.resize(sparse_page_size);
+                }
+                return page[vi % sparse_page_size];
             }
         private:
             Indexer indexer_;
-            std::vector<T> dense_;
-            std::vector<std::size_t> sparse_;
+            std::vector<T, Allocator> dense_;
+            std::vector<sparse_page, page_allocator> sparse_;
         };
 
         template < typename T
-                 , typename Indexer >
+                 , typename Indexer
+                 , typename Allocator >
         void swap(
-            sparse_set<T, Indexer>& l,
-            sparse_set<T, Indexer>& r) noexcept
+            sparse_set<T, Indexer, Allocator>& l,
+            sparse_set<T, Indexer, Allocator>& r) noexcept
         {
             l.swap(r);
         }
@@ -499,11 +669,16 @@ namespace ecs_hpp
     {
         template < typename K
                  , typename T
-                 , typename Indexer = sparse_indexer<K> >
+                 , typename Indexer = sparse_indexer<K>
+                 , typename Allocator = std::allocator<T> >
         class sparse_map final {
+            using key_allocator = typename std::allocator_traits<Allocator>::
+                template rebind_alloc<K>;
         public:
-            using iterator = typename std::vector<K>::iterator;
-            using const_iterator = typename std::vector<K>::const_iterator;
+            using iterator =
+                typename sparse_set<K, Indexer, key_allocator>::iterator;
+            using const_iterator =
+                typename sparse_set<K, Indexer, key_allocator>::const_iterator;
         public:
             iterator begin() noexcept {
                 return keys_.begin();
@@ -532,6 +707,12 @@ namespace ecs_hpp
             sparse_map(const Indexer& indexer = Indexer())
             : keys_(indexer) {}
 
+            explicit sparse_map(
+                const Allocator& alloc,
+                const Indexer& indexer = Indexer())
+            : keys_(key_allocator(alloc), indexer)
+            , values_(alloc) {}
+
             sparse_map(const sparse_map& other) = default;
             sparse_map& operator=(const sparse_map& other) = default;
 
@@ -575,6 +756,66 @@ namespace ecs_hpp
                 }
             }
 
+            // constructs the value directly in the dense storage,
+            // skipping the temporary an insert would move from;
+            // an already taken key leaves the existing value untouched
+            template < typename UK, typename... Args >
+            std::pair<T*, bool> emplace(UK&& k, Args&&... args) {
+                if ( T* value = find(k) ) {
+                    return std::make_pair(value, false);
+                }
+                values_.emplace_back(std::forward<Args>(args)...);
+                try {
+                    keys_.insert(std::forward<UK>(k));
+                    return std::make_pair(&values_.back(), true);
+                } catch (...) {
+                    values_.pop_back();
+                    throw;
+                }
+            }
+
+            // the keys must not be in the map yet;
+            // rolls the map back on exceptions
+            template < typename KeyIterator, typename ValueIterator >
+            void insert_range(KeyIterator first, KeyIterator last, ValueIterator values) {
+                const std::size_t offset = values_.size();
+                const auto count = std::distance(first, last);
+                reserve(offset + static_cast<std::size_t>(count));
+                if constexpr (
+                    std::is_trivially_copyable_v<T> &&
+                    std::is_pointer_v<ValueIterator> )
+                {
+                    // lowers to a single memmove of the whole value block
+                    values_.insert(values_.end(), values, values + count);
+                } else {
+                    for ( auto i = count; i > 0; --i, ++values ) {
+                        values_.push_back(*values);
+                    }
+                }
+                try {
+                    keys_.insert_range(first, last);
+                } catch (...) {
+                    rollback_range_(offset);
+                    throw;
+                }
+            }
+
+            // the keys must not be in the map yet;
+            // inserts a copy of the same value for every key
+            template < typename KeyIterator >
+            void insert_range(KeyIterator first, KeyIterator last, const T& value) {
+                const std::size_t offset = values_.size();
+                const auto count = std::distance(first, last);
+                reserve(offset + static_cast<std::size_t>(count));
+                values_.insert(values_.end(), static_cast<std::size_t>(count), value);
+                try {
+                    keys_.insert_range(first, last);
+                } catch (...) {
+                    rollback_range_(offset);
+                    throw;
+                }
+            }
+
             bool unordered_erase(const K& k) noexcept {
                 const auto value_index_p = keys_.find_dense_index(k);
                 if ( !value_index_p.second ) {
@@ -589,11 +830,52 @@ namespace ecs_hpp
                 return true;
             }
 
+            bool ordered_erase(const K& k) noexcept {
+                const auto value_index_p = keys_.find_dense_index(k);
+                if ( !value_index_p.second ) {
+                    return false;
+                }
+                values_.erase(values_.begin() + value_index_p.first);
+                keys_.ordered_erase(k);
+                return true;
+            }
+
+            void swap_dense(std::size_t l, std::size_t r) noexcept {
+                if ( l == r ) {
+                    return;
+                }
+                using std::swap;
+                keys_.swap_dense(l, r);
+                swap(values_[l], values_[r]);
+            }
+
+            template < typename F >
+            void sort(F&& pred) {
+                std::vector<std::size_t> perm(values_.size());
+                for ( std::size_t i = 0; i < perm.size(); ++i ) {
+                    perm[i] = i;
+                }
+                std::sort(perm.begin(), perm.end(),
+                    [this, &pred](std::size_t l, std::size_t r){
+                        return pred(values_[l], values_[r]);
+                    });
+                apply_dense_order_(perm);
+            }
+
             void clear() noexcept {
                 keys_.clear();
                 values_.clear();
             }
 
+            void reserve(std::size_t size) {
+                keys_.reserve(size);
+                values_.reserve(size);
+            }
+
+            std::size_t capacity() const noexcept {
+                return values_.capacity();
+            }
+
             bool has(const K& k) const noexcept {
                 return keys_.has(k);
             }
@@ -606,6 +888,40 @@ namespace ecs_hpp
                 return values_[keys_.get_dense_index(k)];
             }
 
+            std::size_t get_dense_index(const K& k) const {
+                return keys_.get_dense_index(k);
+            }
+
+            std::pair<std::size_t,bool> find_dense_index(const K& k) const noexcept {
+                return keys_.find_dense_index(k);
+            }
+
+            const K& key_at(std::size_t dense_index) const noexcept {
+                return keys_.at(dense_index);
+            }
+
+            const K* keys_data() const noexcept {
+                return keys_.data();
+            }
+
+            T* values_data() noexcept {
+                return values_.data();
+            }
+
+            const T* values_data() const noexcept {
+                return values_.data();
+            }
+
+            T& value_at(std::size_t dense_index) noexcept {
+                assert(dense_index < values_.size());
+                return values_[dense_index];
+            }
+
+            const T& value_at(std::size_t dense_index) const noexcept {
+                assert(dense_index < values_.size());
+                return values_[dense_index];
+            }
+
             T* find(const K& k) noexcept {
                 const auto value_index_p = keys_.find_dense_index(k);
                 return value_index_p.second
@@ -633,16 +949,39 @@ namespace ecs_hpp
                     + values_.capacity() * sizeof(values_[0]);
             }
         private:
-            sparse_set<K, Indexer> keys_;
-            std::vector<T> values_;
+            void apply_dense_order_(std::vector<std::size_t>& perm) noexcept {
+                for ( std::size_t pos = 0; pos < perm.size(); ++pos ) {
+                    std::size_t curr = pos;
+                    std::size_t next = perm[curr];
+                    while ( curr != next ) {
+                        swap_dense(perm[curr], perm[next]);
+                        perm[curr] = curr;
+                        curr = next;
+                        next = perm[curr];
+                    }
+                }
+            }
+
+            void rollback_range_(std::size_t offset) {
+                while ( keys_.size() > offset ) {
+                    keys_.unordered_erase(keys_.at(keys_.size() - 1u));
+                }
+                values_.erase(
+                    values_.begin() + static_cast<std::ptrdiff_t>(offset),
+                    values_.end());
+            }
+        private:
+            sparse_set<K, Indexer, key_allocator> keys_;
+            std::vector<T, Allocator> values_;
         };
 
         template < typename K
                  , typename T
-                 , typename Indexer >
+                 , typename Indexer
+                 , typename Allocator >
         void swap(
-            sparse_map<K, T, Indexer>& l,
-            sparse_map<K, T, Indexer>& r) noexcept
+            sparse_map<K, T, Indexer, Allocator>& l,
+            sparse_map<K, T, Indexer, Allocator>& r) noexcept
         {
             l.swap(r);
         }
@@ -683,7 +1022,20 @@ namespace ecs_hpp
             virtual bool remove(entity_id id) noexcept = 0;
             virtual bool has(entity_id id) const noexcept = 0;
             virtual void clone(entity_id from, entity_id to) = 0;
+            virtual std::unique_ptr<component_storage_base> clone_empty(registry& owner) const = 0;
+            virtual void move_to(entity_id from, component_storage_base& dst, entity_id to) = 0;
+            virtual void reserve(std::size_t count) = 0;
+            virtual std::size_t capacity() const noexcept = 0;
             virtual std::size_t memory_usage() const noexcept = 0;
+        #if defined(ECS_HPP_ENABLE_STATS)
+        public:
+            struct storage_stats {
+                std::uint64_t inserts{0u};
+                std::uint64_t erases{0u};
+                std::uint64_t probe_misses{0u};
+            };
+            mutable storage_stats stats;
+        #endif
         };
 
         template < typename T, bool E = std::is_empty_v<T> >
@@ -695,11 +1047,47 @@ namespace ecs_hpp
             template < typename... Args >
             T& assign(entity_id id, Args&&... args) {
                 if ( T* value = components_.find(id) ) {
-                    *value = T{std::forward<Args>(args)...};
+                    // a ready value is assigned through, so a moved-in
+                    // component skips the temporary entirely
+                    if constexpr ( is_value_pass_v_<Args...> ) {
+                        ((*value = std::forward<Args>(args)), ...);
+                    } else {
+                        *value = T{std::forward<Args>(args)...};
+                    }
+                    mark_changed(id);
+                    return *value;
+                }
+                assert(!components_locker_.is_locked());
+                T* value = nullptr;
+                if constexpr ( is_value_pass_v_<Args...> ) {
+                    value = components_.insert(id, std::forward<Args>(args)...).first;
+                } else {
+                    value = components_.insert(id, T{std::forward<Args>(args)...}).first;
+                }
+                ECS_HPP_STATS_INC(stats.inserts);
+                mark_changed(id);
+                return *value;
+            }
+
+            // constructs the component directly in the dense storage
+            // with parenthesized initialization; an existing component
+            // is replaced by assignment like assign()
+            template < typename... Args >
+            T& emplace(entity_id id, Args&&... args) {
+                if ( T* value = components_.find(id) ) {
+                    if constexpr ( is_value_pass_v_<Args...> ) {
+                        ((*value = std::forward<Args>(args)), ...);
+                    } else {
+                        *value = T(std::forward<Args>(args)...);
+                    }
+                    mark_changed(id);
                     return *value;
                 }
                 assert(!components_locker_.is_locked());
-                return *components_.insert(id, T{std::forward<Args>(args)...}).first;
+                T& value = *components_.emplace(id, std::forward<Args>(args)...).first;
+                ECS_HPP_STATS_INC(stats.inserts);
+                mark_changed(id);
+                return value;
             }
 
             template < typename... Args >
@@ -708,7 +1096,31 @@ namespace ecs_hpp
                     return *value;
                 }
                 assert(!components_locker_.is_locked());
-                return *components_.insert(id, T{std::forward<Args>(args)...}).first;
+                T* value = nullptr;
+                if constexpr ( is_value_pass_v_<Args...> ) {
+                    value = components_.insert(id, std::forward<Args>(args)...).first;
+                } else {
+                    value = components_.insert(id, T{std::forward<Args>(args)...}).first;
+                }
+                ECS_HPP_STATS_INC(stats.inserts);
+                mark_changed(id);
+                return *value;
+            }
+
+            // the entities must not own the component yet
+            template < typename Iterator, typename ValueIterator >
+            void insert_range(Iterator first, Iterator last, ValueIterator values) {
+                assert(!components_locker_.is_locked());
+                components_.insert_range(first, last, values);
+                on_range_inserted_(first, last);
+            }
+
+            // the entities must not own the component yet
+            template < typename Iterator >
+            void insert_range(Iterator first, Iterator last, const T& value) {
+                assert(!components_locker_.is_locked());
+                components_.insert_range(first, last, value);
+                on_range_inserted_(first, last);
             }
 
             bool exists(entity_id id) const noexcept {
@@ -717,28 +1129,93 @@ namespace ecs_hpp
 
             bool remove(entity_id id) noexcept override {
                 assert(!components_locker_.is_locked());
-                return components_.unordered_erase(id);
+                changed_.unordered_erase(id);
+                const bool removed = std::is_same_v<
+                        component_storage_policy_t<T>,
+                        stable_storage_policy>
+                    ? components_.ordered_erase(id)
+                    : components_.unordered_erase(id);
+                if ( removed ) {
+                    ECS_HPP_STATS_INC(stats.erases);
+                }
+                return removed;
             }
 
             std::size_t remove_all() noexcept {
                 assert(!components_locker_.is_locked());
                 const std::size_t count = components_.size();
                 components_.clear();
+                changed_.clear();
                 return count;
             }
 
             T* find(entity_id id) noexcept {
-                return components_.find(id);
+                T* value = components_.find(id);
+                if ( !value ) {
+                    ECS_HPP_STATS_INC(stats.probe_misses);
+                }
+                return value;
             }
 
             const T* find(entity_id id) const noexcept {
-                return components_.find(id);
+                const T* value = components_.find(id);
+                if ( !value ) {
+                    ECS_HPP_STATS_INC(stats.probe_misses);
+                }
+                return value;
             }
 
             std::size_t count() const noexcept {
                 return components_.size();
             }
 
+            std::size_t get_dense_index(entity_id id) const {
+                return components_.get_dense_index(id);
+            }
+
+            std::pair<std::size_t,bool> find_dense_index(entity_id id) const noexcept {
+                return components_.find_dense_index(id);
+            }
+
+            void swap_dense(std::size_t l, std::size_t r) noexcept {
+                assert(!components_locker_.is_locked());
+                components_.swap_dense(l, r);
+            }
+
+            template < typename F >
+            void sort(F&& pred) {
+                assert(!components_locker_.is_locked());
+                components_.sort(std::forward<F>(pred));
+            }
+
+            entity_id id_at(std::size_t dense_index) const noexcept {
+                return components_.key_at(dense_index);
+            }
+
+            const entity_id* ids_data() const noexcept {
+                return components_.keys_data();
+            }
+
+            T* values_data() noexcept {
+                return components_.values_data();
+            }
+
+            const T* values_data() const noexcept {
+                return components_.values_data();
+            }
+
+            T& value_at(std::size_t dense_index) noexcept {
+                return components_.value_at(dense_index);
+            }
+
+            const T& value_at(std::size_t dense_index) const noexcept {
+                return components_.value_at(dense_index);
+            }
+
+            incremental_locker& locker() const noexcept {
+                return components_locker_;
+            }
+
             bool has(entity_id id) const noexcept override {
                 return components_.has(id);
             }
@@ -749,6 +1226,26 @@ namespace ecs_hpp
                 }
             }
 
+            std::unique_ptr<component_storage_base> clone_empty(registry& owner) const override {
+                return std::make_unique<component_storage>(owner);
+            }
+
+            // the destination must be a storage of the same component
+            // type, which the family id match guarantees
+            void move_to(entity_id from, component_storage_base& dst, entity_id to) override {
+                if ( T* c = components_.find(from) ) {
+                    static_cast<component_storage&>(dst).assign(to, std::move(*c));
+                }
+            }
+
+            void reserve(std::size_t count) override {
+                components_.reserve(count);
+            }
+
+            std::size_t capacity() const noexcept override {
+                return components_.capacity();
+            }
+
             template < typename F >
             void for_each_component(F&& f) {
                 detail::incremental_lock_guard lock(components_locker_);
@@ -765,13 +1262,63 @@ namespace ecs_hpp
                 }
             }
 
+            void set_tracking(bool enabled) {
+                tracking_ = enabled;
+                if ( !enabled ) {
+                    changed_.clear();
+                }
+            }
+
+            bool tracking() const noexcept {
+                return tracking_;
+            }
+
+            void mark_changed(entity_id id) {
+                if ( tracking_ ) {
+                    changed_.insert(id);
+                }
+            }
+
+            void clear_changed() noexcept {
+                changed_.clear();
+            }
+
+            template < typename F >
+            void for_each_changed(F&& f) {
+                detail::incremental_lock_guard lock(components_locker_);
+                for ( const entity_id id : changed_ ) {
+                    f(id, components_.get(id));
+                }
+            }
+
             std::size_t memory_usage() const noexcept override {
                 return components_.memory_usage();
             }
+        private:
+            // a single argument that already is a T is assigned or
+            // inserted as is instead of going through a temporary
+            template < typename... Args >
+            static constexpr bool is_value_pass_v_ =
+                sizeof...(Args) == 1u &&
+                (... && std::is_same_v<std::decay_t<Args>, T>);
+
+            template < typename Iterator >
+            void on_range_inserted_(Iterator first, Iterator last) {
+            #if defined(ECS_HPP_ENABLE_STATS)
+                stats.inserts += static_cast<std::uint64_t>(std::distance(first, last));
+            #endif
+                if ( tracking_ ) {
+                    for ( ; first != last; ++first ) {
+                        changed_.insert(*first);
+                    }
+                }
+            }
         private:
             registry& owner_;
+            bool tracking_{false};
             mutable detail::incremental_locker components_locker_;
             detail::sparse_map<entity_id, T, entity_id_indexer> components_;
+            detail::sparse_set<entity_id, entity_id_indexer> changed_;
         };
 
         template < typename T >
@@ -783,13 +1330,21 @@ namespace ecs_hpp
             template < typename... Args >
             T& assign(entity_id id, Args&&...) {
                 if ( components_.has(id) ) {
+                    mark_changed(id);
                     return empty_value_;
                 }
                 assert(!components_locker_.is_locked());
                 components_.insert(id);
+                ECS_HPP_STATS_INC(stats.inserts);
+                mark_changed(id);
                 return empty_value_;
             }
 
+            template < typename... Args >
+            T& emplace(entity_id id, Args&&... args) {
+                return assign(id, std::forward<Args>(args)...);
+            }
+
             template < typename... Args >
             T& ensure(entity_id id, Args&&...) {
                 if ( components_.has(id) ) {
@@ -797,41 +1352,110 @@ namespace ecs_hpp
                 }
                 assert(!components_locker_.is_locked());
                 components_.insert(id);
+                ECS_HPP_STATS_INC(stats.inserts);
+                mark_changed(id);
                 return empty_value_;
             }
 
+            // the entities must not own the component yet
+            template < typename Iterator >
+            void insert_range(Iterator first, Iterator last, const T&) {
+                assert(!components_locker_.is_locked());
+                components_.insert_range(first, last);
+            #if defined(ECS_HPP_ENABLE_STATS)
+                stats.inserts += static_cast<std::uint64_t>(std::distance(first, last));
+            #endif
+                if ( tracking_ ) {
+                    for ( ; first != last; ++first ) {
+                        changed_.insert(*first);
+                    }
+                }
+            }
+
             bool exists(entity_id id) const noexcept {
                 return components_.has(id);
             }
 
             bool remove(entity_id id) noexcept override {
                 assert(!components_locker_.is_locked());
-                return components_.unordered_erase(id);
+                changed_.unordered_erase(id);
+                const bool removed = std::is_same_v<
+                        component_storage_policy_t<T>,
+                        stable_storage_policy>
+                    ? components_.ordered_erase(id)
+                    : components_.unordered_erase(id);
+                if ( removed ) {
+                    ECS_HPP_STATS_INC(stats.erases);
+                }
+                return removed;
             }
 
             std::size_t remove_all() noexcept {
                 assert(!components_locker_.is_locked());
                 const std::size_t count = components_.size();
                 components_.clear();
+                changed_.clear();
                 return count;
             }
 
             T* find(entity_id id) noexcept {
-                return components_.has(id)
-                    ? &empty_value_
-                    : nullptr;
+                if ( components_.has(id) ) {
+                    return &empty_value_;
+                }
+                ECS_HPP_STATS_INC(stats.probe_misses);
+                return nullptr;
             }
 
             const T* find(entity_id id) const noexcept {
-                return components_.has(id)
-                    ? &empty_value_
-                    : nullptr;
+                if ( components_.has(id) ) {
+                    return &empty_value_;
+                }
+                ECS_HPP_STATS_INC(stats.probe_misses);
+                return nullptr;
             }
 
             std::size_t count() const noexcept {
                 return components_.size();
             }
 
+            std::size_t get_dense_index(entity_id id) const {
+                return components_.get_dense_index(id);
+            }
+
+            std::pair<std::size_t,bool> find_dense_index(entity_id id) const noexcept {
+                return components_.find_dense_index(id);
+            }
+
+            void swap_dense(std::size_t l, std::size_t r) noexcept {
+                assert(!components_locker_.is_locked());
+                components_.swap_dense(l, r);
+            }
+
+            template < typename F >
+            void sort(F&&) noexcept {
+                // all empty components compare equal, any dense order is sorted
+            }
+
+            entity_id id_at(std::size_t dense_index) const noexcept {
+                return components_.at(dense_index);
+            }
+
+            const entity_id* ids_data() const noexcept {
+                return components_.data();
+            }
+
+            T& value_at(std::size_t) noexcept {
+                return empty_value_;
+            }
+
+            const T& value_at(std::size_t) const noexcept {
+                return empty_value_;
+            }
+
+            incremental_locker& locker() const noexcept {
+                return components_locker_;
+            }
+
             bool has(entity_id id) const noexcept override {
                 return components_.has(id);
             }
@@ -842,6 +1466,24 @@ namespace ecs_hpp
                 }
             }
 
+            std::unique_ptr<component_storage_base> clone_empty(registry& owner) const override {
+                return std::make_unique<component_storage>(owner);
+            }
+
+            void move_to(entity_id from, component_storage_base& dst, entity_id to) override {
+                if ( components_.has(from) ) {
+                    static_cast<component_storage&>(dst).assign(to);
+                }
+            }
+
+            void reserve(std::size_t count) override {
+                components_.reserve(count);
+            }
+
+            std::size_t capacity() const noexcept override {
+                return components_.capacity();
+            }
+
             template < typename F >
             void for_each_component(F&& f) {
                 detail::incremental_lock_guard lock(components_locker_);
@@ -858,14 +1500,45 @@ namespace ecs_hpp
                 }
             }
 
-            std::size_t memory_usage() const noexcept override {
-                return components_.memory_usage();
+            void set_tracking(bool enabled) {
+                tracking_ = enabled;
+                if ( !enabled ) {
+                    changed_.clear();
+                }
             }
-        private:
-            registry& owner_;
-            static T empty_value_;
-            mutable detail::incremental_locker components_locker_;
-            detail::sparse_set<entity_id, entity_id_indexer> components_;
+
+            bool tracking() const noexcept {
+                return tracking_;
+            }
+
+            void mark_changed(entity_id id) {
+                if ( tracking_ ) {
+                    changed_.insert(id);
+                }
+            }
+
+            void clear_changed() noexcept {
+                changed_.clear();
+            }
+
+            template < typename F >
+            void for_each_changed(F&& f) {
+                detail::incremental_lock_guard lock(components_locker_);
+                for ( const entity_id id : changed_ ) {
+                    f(id, empty_value_);
+                }
+            }
+
+            std::size_t memory_usage() const noexcept override {
+                return components_.memory_usage();
+            }
+        private:
+            registry& owner_;
+            static T empty_value_;
+            bool tracking_{false};
+            mutable detail::incremental_locker components_locker_;
+            detail::sparse_set<entity_id, entity_id_indexer> components_;
+            detail::sparse_set<entity_id, entity_id_indexer> changed_;
         };
 
         template < typename T >
@@ -873,6 +1546,71 @@ namespace ecs_hpp
     }
 }
 
+// -----------------------------------------------------------------------------
+//
+// detail::group_base
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    namespace detail
+    {
+        class group_base {
+        public:
+            virtual ~group_base() = default;
+            virtual bool owns(family_id family) const noexcept = 0;
+            virtual void on_assign(entity_id id) noexcept = 0;
+            virtual void on_remove(entity_id id) noexcept = 0;
+            virtual void on_remove_all() noexcept = 0;
+        };
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// detail::snapshot
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    namespace detail
+    {
+        template < typename Writer, typename T >
+        void snapshot_write_value(Writer& writer, const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            writer(&value, sizeof(value));
+        }
+
+        template < typename Writer, typename T >
+        void snapshot_write_array(Writer& writer, const T* values, std::size_t count) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            snapshot_write_value(writer, std::uint64_t(count));
+            if ( count ) {
+                writer(values, count * sizeof(T));
+            }
+        }
+
+        template < typename Reader, typename T >
+        void snapshot_read_value(Reader& reader, T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            reader(&value, sizeof(value));
+        }
+
+        template < typename Reader, typename T >
+        void snapshot_read_vector(Reader& reader, std::vector<T>& values) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            std::uint64_t count = 0u;
+            snapshot_read_value(reader, count);
+            values.resize(static_cast<std::size_t>(count));
+            if ( count ) {
+                reader(values.data(), values.size() * sizeof(T));
+            }
+        }
+    }
+}
+
 // -----------------------------------------------------------------------------
 //
 // entity
@@ -904,9 +1642,15 @@ namespace ecs_hpp
         template < typename T, typename... Args >
         T& assign_component(Args&&... args);
 
+        template < typename T, typename... Args >
+        T& emplace_component(Args&&... args);
+
         template < typename T, typename... Args >
         T& ensure_component(Args&&... args);
 
+        template < typename T, typename F >
+        T& patch_component(F&& f);
+
         template < typename T >
         bool remove_component() noexcept;
 
@@ -937,6 +1681,9 @@ namespace ecs_hpp
         template < typename... Ts >
         std::tuple<const Ts*...> find_components() const noexcept;
 
+        template < typename... Ts >
+        std::tuple<Ts&...> get_or_assign_components();
+
         std::size_t component_count() const noexcept;
     private:
         registry* owner_{nullptr};
@@ -1167,7 +1914,7 @@ namespace std
 
 // -----------------------------------------------------------------------------
 //
-// prototype
+// detail::poly_buffer
 //
 // -----------------------------------------------------------------------------
 
@@ -1175,14 +1922,248 @@ namespace ecs_hpp
 {
     namespace detail
     {
-        class applier_base;
-        using applier_uptr = std::unique_ptr<applier_base>;
+        // an owning container of polymorphic objects with small-buffer
+        // storage: objects below the inline threshold are constructed back
+        // to back in one contiguous blob, so walking the container in index
+        // order touches a single allocation; oversized, over-aligned and
+        // potentially throwing movers fall back to their own heap nodes.
+        // slot indices stay stable for the container lifetime and erased
+        // slots are kept as holes
+        template < typename Base >
+        class poly_buffer final {
+            static_assert(
+                std::has_virtual_destructor_v<Base>,
+                "base type should have a virtual destructor");
+        public:
+            static constexpr std::size_t inline_size_threshold{256u};
+
+            poly_buffer() = default;
+
+            ~poly_buffer() noexcept {
+                destroy_objects_();
+            }
+
+            poly_buffer(const poly_buffer& other) {
+                try {
+                    for ( const slot_t& s : other.slots_ ) {
+                        if ( s.obj ) {
+                            assert(s.clone);
+                            s.clone(s.obj, *this);
+                        } else {
+                            slots_.push_back(slot_t{});
+                        }
+                    }
+                } catch (...) {
+                    destroy_objects_();
+                    throw;
+                }
+            }
+
+            poly_buffer& operator=(const poly_buffer& other) {
+                if ( this != &other ) {
+                    poly_buffer b(other);
+                    swap(b);
+                }
+                return *this;
+            }
+
+            poly_buffer(poly_buffer&& other) noexcept {
+                swap(other);
+            }
+
+            poly_buffer& operator=(poly_buffer&& other) noexcept {
+                if ( this != &other ) {
+                    clear();
+                    swap(other);
+                }
+                return *this;
+            }
+
+            // constructs a new object in place and returns its slot index;
+            // growing the blob relocates inline objects, so raw pointers
+            // taken from earlier slots are invalidated by this call
+            template < typename T, typename... Args >
+            std::size_t emplace(Args&&... args) {
+                static_assert(
+                    std::is_base_of_v<Base, T>,
+                    "type should be derived from the base type");
+                if constexpr ( is_inlinable_v_<T> ) {
+                    const std::size_t offset = aligned_offset_(used_, alignof(T));
+                    if ( offset + sizeof(T) > blob_.size() ) {
+                        grow_blob_(offset + sizeof(T));
+                    }
+                    T* obj = new (blob_.data() + offset) T(std::forward<Args>(args)...);
+                    try {
+                        slots_.push_back(make_slot_<T>(obj, offset, true));
+                    } catch (...) {
+                        obj->~T();
+                        throw;
+                    }
+                    used_ = offset + sizeof(T);
+                } else {
+                    auto obj = std::make_unique<T>(std::forward<Args>(args)...);
+                    slots_.push_back(make_slot_<T>(obj.get(), 0u, false));
+                    obj.release();
+                }
+                return slots_.size() - 1u;
+            }
+
+            // destroys the object and leaves a hole,
+            // keeping the other slot indices stable
+            void destroy_at(std::size_t index) noexcept {
+                assert(index < slots_.size());
+                slot_t& s = slots_[index];
+                assert(s.obj);
+                if ( s.inlined ) {
+                    s.obj->~Base();
+                } else {
+                    delete s.obj;
+                }
+                s = slot_t{};
+            }
+
+            // appends a copy of the object at index into the destination
+            // buffer and returns its new slot index
+            std::size_t clone_into(std::size_t index, poly_buffer& dst) const {
+                assert(index < slots_.size());
+                const slot_t& s = slots_[index];
+                assert(s.obj && s.clone);
+                s.clone(s.obj, dst);
+                return dst.slots_.size() - 1u;
+            }
+
+            bool has(std::size_t index) const noexcept {
+                return index < slots_.size() && slots_[index].obj;
+            }
+
+            Base& operator[](std::size_t index) noexcept {
+                assert(has(index));
+                return *slots_[index].obj;
+            }
+
+            const Base& operator[](std::size_t index) const noexcept {
+                assert(has(index));
+                return *slots_[index].obj;
+            }
+
+            std::size_t size() const noexcept {
+                return slots_.size();
+            }
+
+            bool empty() const noexcept {
+                return slots_.empty();
+            }
+
+            void clear() noexcept {
+                destroy_objects_();
+                slots_.clear();
+                used_ = 0u;
+            }
+
+            void swap(poly_buffer& other) noexcept {
+                using std::swap;
+                swap(blob_, other.blob_);
+                swap(slots_, other.slots_);
+                swap(used_, other.used_);
+            }
+        private:
+            struct slot_t final {
+                Base* obj{nullptr};
+                std::size_t offset{0u};
+                bool inlined{false};
+                Base* (*relocate)(void* from, void* to) noexcept {nullptr};
+                void (*clone)(const Base* from, poly_buffer& to){nullptr};
+            };
+
+            // the blob memory comes max-aligned from operator new,
+            // so relative offsets are enough while the object alignment fits
+            template < typename T >
+            static constexpr bool is_inlinable_v_ =
+                sizeof(T) <= inline_size_threshold &&
+                alignof(T) <= alignof(std::max_align_t) &&
+                std::is_nothrow_move_constructible_v<T>;
+
+            static std::size_t aligned_offset_(
+                std::size_t offset,
+                std::size_t align) noexcept
+            {
+                return (offset + align - 1u) & ~(align - 1u);
+            }
+
+            template < typename T >
+            static slot_t make_slot_(T* obj, std::size_t offset, bool inlined) noexcept {
+                slot_t s;
+                s.obj = obj;
+                s.offset = offset;
+                s.inlined = inlined;
+                if constexpr ( is_inlinable_v_<T> ) {
+                    s.relocate = [](void* from, void* to) noexcept -> Base* {
+                        T* src = static_cast<T*>(from);
+                        T* dst = new (to) T(std::move(*src));
+                        src->~T();
+                        return dst;
+                    };
+                }
+                if constexpr ( std::is_copy_constructible_v<T> ) {
+                    // the local copy keeps cloning a slot into its own
+                    // buffer safe when the blob grows mid-emplace;
+                    // dynamic_cast, because the base may be virtual
+                    s.clone = [](const Base* from, poly_buffer& to){
+                        T copy(dynamic_cast<const T&>(*from));
+                        to.emplace<T>(std::move(copy));
+                    };
+                }
+                return s;
+            }
+
+            void grow_blob_(std::size_t min_size) {
+                std::vector<std::uint8_t> new_blob(next_capacity_size(
+                    blob_.size(), min_size, blob_.max_size()));
+                for ( slot_t& s : slots_ ) {
+                    if ( s.obj && s.inlined ) {
+                        s.obj = s.relocate(
+                            blob_.data() + s.offset,
+                            new_blob.data() + s.offset);
+                    }
+                }
+                blob_.swap(new_blob);
+            }
+
+            void destroy_objects_() noexcept {
+                for ( auto iter = slots_.rbegin(); iter != slots_.rend(); ++iter ) {
+                    if ( !iter->obj ) {
+                        continue;
+                    }
+                    if ( iter->inlined ) {
+                        iter->obj->~Base();
+                    } else {
+                        delete iter->obj;
+                    }
+                }
+            }
+        private:
+            std::vector<std::uint8_t> blob_;
+            std::vector<slot_t> slots_;
+            std::size_t used_{0u};
+        };
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// prototype
+//
+// -----------------------------------------------------------------------------
 
+namespace ecs_hpp
+{
+    namespace detail
+    {
         class applier_base {
         public:
             virtual ~applier_base() = default;
-            virtual applier_uptr clone() const = 0;
             virtual void apply_to_entity(entity& ent, bool override) const = 0;
+            virtual void bake_into(baked_prototype& baked) const = 0;
         };
 
         template < typename T >
@@ -1196,8 +2177,8 @@ namespace ecs_hpp
         public:
             typed_applier_with_args(std::tuple<Args...>&& args);
             typed_applier_with_args(const std::tuple<Args...>& args);
-            applier_uptr clone() const override;
             void apply_to_entity(entity& ent, bool override) const override;
+            void bake_into(baked_prototype& baked) const override;
             void apply_to_component(T& component) const override;
         private:
             std::tuple<Args...> args_;
@@ -1233,13 +2214,67 @@ namespace ecs_hpp
         template < typename T >
         bool apply_to_component(T& component) const;
         void apply_to_entity(entity& ent, bool override) const;
+
+        template < typename Iterator >
+        void apply_to_entities(Iterator first, Iterator last, bool override) const;
+
+        void bake_into(baked_prototype& baked) const;
+    private:
+        void set_applier_(family_id family, std::size_t index);
     private:
-        detail::sparse_map<
-            family_id,
-            detail::applier_uptr> appliers_;
+        // appliers live inline in the buffer; the map holds slot indices,
+        // so copying a prototype clones one blob instead of N heap nodes
+        detail::sparse_map<family_id, std::size_t> appliers_;
+        detail::poly_buffer<detail::applier_base> appliers_buffer_;
     };
 
     void swap(prototype& l, prototype& r) noexcept;
+
+    class baked_prototype final {
+    public:
+        baked_prototype() = default;
+        ~baked_prototype() noexcept = default;
+
+        explicit baked_prototype(const prototype& proto);
+
+        baked_prototype(const baked_prototype& other) = default;
+        baked_prototype& operator=(const baked_prototype& other) = default;
+
+        baked_prototype(baked_prototype&& other) noexcept = default;
+        baked_prototype& operator=(baked_prototype&& other) noexcept = default;
+
+        void clear() noexcept;
+        bool empty() const noexcept;
+        void swap(baked_prototype& other) noexcept;
+
+        template < typename T >
+        bool has_component() const noexcept;
+
+        template < typename T >
+        baked_prototype& component(T value) &;
+        template < typename T >
+        baked_prototype&& component(T value) &&;
+
+        void apply_to_entity(entity& ent, bool override) const;
+
+        template < typename Iterator >
+        void apply_to_entities(Iterator first, Iterator last, bool override) const;
+    private:
+        struct baked_op final {
+            family_id family{0u};
+            std::size_t offset{0u};
+            void (*apply)(entity& ent, const void* value, bool override){nullptr};
+        };
+
+        template < typename T >
+        static void apply_op_(entity& ent, const void* value, bool override);
+    private:
+        std::vector<std::uint8_t> blob_;
+        std::vector<baked_op> ops_;
+        prototype fallback_;
+    };
+
+    void swap(baked_prototype& l, baked_prototype& r) noexcept;
 }
 
 // -----------------------------------------------------------------------------
@@ -1271,10 +2306,77 @@ namespace ecs_hpp
 
 namespace ecs_hpp
 {
+    class system_access final {
+    public:
+        system_access() = default;
+
+        template < typename... Ts >
+        system_access& read() & {
+            declared_ = true;
+            (... , reads_.push_back(detail::type_family<Ts>::id()));
+            return *this;
+        }
+
+        template < typename... Ts >
+        system_access&& read() && {
+            read<Ts...>();
+            return std::move(*this);
+        }
+
+        template < typename... Ts >
+        system_access& write() & {
+            declared_ = true;
+            (... , writes_.push_back(detail::type_family<Ts>::id()));
+            return *this;
+        }
+
+        template < typename... Ts >
+        system_access&& write() && {
+            write<Ts...>();
+            return std::move(*this);
+        }
+
+        bool declared() const noexcept {
+            return declared_;
+        }
+
+        bool conflicts_with(const system_access& other) const noexcept {
+            // undeclared systems may touch anything and never run concurrently
+            if ( !declared_ || !other.declared_ ) {
+                return true;
+            }
+            return intersects_(writes_, other.writes_)
+                || intersects_(writes_, other.reads_)
+                || intersects_(reads_, other.writes_);
+        }
+    private:
+        static bool intersects_(
+            const std::vector<family_id>& l,
+            const std::vector<family_id>& r) noexcept
+        {
+            for ( const family_id lf : l ) {
+                for ( const family_id rf : r ) {
+                    if ( lf == rf ) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+    private:
+        bool declared_{false};
+        std::vector<family_id> reads_;
+        std::vector<family_id> writes_;
+    };
+
     template <>
     class system<> {
     public:
         virtual ~system() = default;
+
+        virtual system_access access() const {
+            return system_access{};
+        }
     };
 
     template < typename E >
@@ -1282,6 +2384,15 @@ namespace ecs_hpp
         : public virtual system<> {
     public:
         virtual void process(registry& owner, const E& event) = 0;
+
+        // called by the deferred dispatch with a whole batch of queued
+        // events at once; override it to amortize per-event setup work,
+        // the default just forwards every event to process()
+        virtual void process_batch(registry& owner, const E* events, std::size_t event_count) {
+            for ( std::size_t i = 0; i < event_count; ++i ) {
+                process(owner, events[i]);
+            }
+        }
     };
 
     template < typename E, typename... Es>
@@ -1324,13 +2435,88 @@ namespace ecs_hpp
 
         template < typename Event >
         feature& process_event(registry& owner, const Event& event);
+
+        // processes a contiguous batch of events in one pass: every
+        // before<Event> trigger fires per event first, then each
+        // interested system receives the whole batch at once, and
+        // every after<Event> trigger fires per event last
+        template < typename Event >
+        feature& process_events(registry& owner, const Event* events, std::size_t event_count);
+
+        template < typename Executor, typename Event >
+        feature& process_event_par(registry& owner, Executor& executor, const Event& event);
+
+        // seconds of process() time accumulated per system index;
+        // empty unless built with ECS_HPP_ENABLE_STATS
+        std::vector<double> system_times() const;
+        feature& reset_stats() noexcept;
+    private:
+        template < typename Event >
+        std::vector<void*>& handlers_for_();
+
+        template < typename Event >
+        void fire_event_(registry& owner, const Event& event);
+
+        template < typename Event >
+        void fire_events_(registry& owner, const Event* events, std::size_t event_count);
+
+        template < typename Executor, typename Event >
+        void fire_event_par_(registry& owner, Executor& executor, const Event& event);
     private:
         bool disabled_{false};
-        std::vector<std::unique_ptr<system<>>> systems_;
+        detail::poly_buffer<system<>> systems_;
         mutable detail::incremental_locker systems_locker_;
+        detail::sparse_map<family_id, std::vector<void*>> dispatch_cache_;
+    #if defined(ECS_HPP_ENABLE_STATS)
+        std::vector<double> system_times_;
+    #endif
     };
 }
 
+// -----------------------------------------------------------------------------
+//
+// detail::event_queue
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    namespace detail
+    {
+        class event_queue_base {
+        public:
+            virtual ~event_queue_base() = default;
+            virtual bool empty() const noexcept = 0;
+            virtual void clear() noexcept = 0;
+            virtual void dispatch(registry& owner) = 0;
+        };
+
+        // a contiguous per-event-type queue: enqueued events are appended
+        // to one dense array and handed to the interested systems in a
+        // single batch, so the dispatch cost is paid once per queue
+        // instead of once per event
+        template < typename E >
+        class typed_event_queue final : public event_queue_base {
+        public:
+            void push(E event) {
+                events_.push_back(std::move(event));
+            }
+
+            bool empty() const noexcept override {
+                return events_.empty();
+            }
+
+            void clear() noexcept override {
+                events_.clear();
+            }
+
+            void dispatch(registry& owner) override;
+        private:
+            std::vector<E> events_;
+        };
+    }
+}
+
 // -----------------------------------------------------------------------------
 //
 // registry
@@ -1401,17 +2587,55 @@ namespace ecs_hpp
 
         entity create_entity();
         entity create_entity(const prototype& proto);
+        entity create_entity(const baked_prototype& proto);
         entity create_entity(const const_uentity& proto);
 
+        template < typename Iterator >
+        Iterator create_entities(std::size_t count, Iterator iter);
+        template < typename Iterator >
+        Iterator create_entities(std::size_t count, const prototype& proto, Iterator iter);
+        template < typename Iterator >
+        Iterator create_entities(std::size_t count, const baked_prototype& proto, Iterator iter);
+        template < typename Iterator >
+        Iterator clone_n(const const_uentity& proto, std::size_t count, Iterator iter);
+
+        // transfers an entity with all its components to another
+        // registry and returns the new entity in the destination
+        entity move_entity(const uentity& ent, registry& dst);
+
         void destroy_entity(const uentity& ent) noexcept;
+
+        template < typename Iterator >
+        void destroy_entities(Iterator first, Iterator last) noexcept;
+
         bool valid_entity(const const_uentity& ent) const noexcept;
 
         template < typename T, typename... Args >
         T& assign_component(const uentity& ent, Args&&... args);
 
+        // constructs the component directly in the storage slot with
+        // parenthesized initialization, so heavy payloads skip the
+        // temporary assign_component materializes
+        template < typename T, typename... Args >
+        T& emplace_component(const uentity& ent, Args&&... args);
+
         template < typename T, typename... Args >
         T& ensure_component(const uentity& ent, Args&&... args);
 
+        // batch assigns one component type to a range of entity ids;
+        // the entities must be valid and must not own the component yet
+        template < typename T
+                 , typename Iterator
+                 , typename ValueIterator
+                 , typename = std::enable_if_t<
+                     !std::is_same_v<std::decay_t<ValueIterator>, T>> >
+        void insert(Iterator ids_first, Iterator ids_last, ValueIterator values_first);
+        template < typename T, typename Iterator >
+        void insert(Iterator ids_first, Iterator ids_last, const T& value);
+
+        template < typename T, typename F >
+        T& patch_component(const uentity& ent, F&& f);
+
         template < typename T >
         bool remove_component(const uentity& ent) noexcept;
 
@@ -1443,11 +2667,27 @@ namespace ecs_hpp
         template < typename... Ts >
         std::tuple<const Ts*...> find_components(const const_uentity& ent) const noexcept;
 
+        template < typename... Ts >
+        std::tuple<Ts&...> get_or_assign_components(const uentity& ent);
+
         template < typename T >
         std::size_t component_count() const noexcept;
         std::size_t entity_count() const noexcept;
         std::size_t entity_component_count(const const_uentity& ent) const noexcept;
 
+        void reserve_entities(std::size_t count);
+        template < typename T >
+        void reserve(std::size_t count);
+
+        std::size_t entity_capacity() const noexcept;
+        template < typename T >
+        std::size_t component_capacity() const noexcept;
+
+        template < typename... Ts, typename Writer >
+        void snapshot(Writer&& writer) const;
+        template < typename... Ts, typename Reader >
+        void restore(Reader&& reader);
+
         template < typename F, typename... Opts >
         void for_each_entity(F&& f, Opts&&... opts);
         template < typename F, typename... Opts >
@@ -1458,13 +2698,37 @@ namespace ecs_hpp
         template < typename T, typename F, typename... Opts >
         void for_each_component(F&& f, Opts&&... opts) const;
 
+        template < typename T >
+        void track_changes(bool enabled = true);
+        template < typename T, typename F, typename... Opts >
+        void for_changed_components(F&& f, Opts&&... opts);
+
+        template < typename T, typename F >
+        void sort(F&& compare);
+        template < typename T, typename U >
+        void sort_as();
+
         template < typename... Ts, typename F, typename... Opts >
         void for_joined_components(F&& f, Opts&&... opts);
         template < typename... Ts, typename F, typename... Opts >
         void for_joined_components(F&& f, Opts&&... opts) const;
 
-        template < typename Tag, typename... Args >
-        feature& assign_feature(Args&&... args);
+        template < typename... Ts, typename Executor, typename F, typename... Opts >
+        void for_joined_components_par(Executor& executor, F&& f, Opts&&... opts);
+
+        template < typename... Ts >
+        ecs_hpp::view<Ts...> view() noexcept;
+
+        template < typename T >
+        ecs_hpp::raw_view<T> raw_view() noexcept;
+        template < typename T >
+        ecs_hpp::const_raw_view<T> raw_view() const noexcept;
+
+        template < typename... Ts >
+        ecs_hpp::group<Ts...>& group();
+
+        template < typename Tag, typename... Args >
+        feature& assign_feature(Args&&... args);
 
         template < typename Tag, typename... Args >
         feature& ensure_feature(Args&&... args);
@@ -1481,6 +2745,39 @@ namespace ecs_hpp
         template < typename Event >
         registry& process_event(const Event& event);
 
+        template < typename Executor, typename Event >
+        registry& process_event_par(Executor& executor, const Event& event);
+
+        template < typename Iterator >
+        registry& process_events(Iterator first, Iterator last);
+
+        // processes a contiguous batch of one event type in one pass,
+        // handing each interested system the whole span at once
+        template < typename Event >
+        registry& process_events(const Event* events, std::size_t event_count);
+
+        // appends the event to its per-type queue without processing it;
+        // the queued events are handled by the next dispatch_events() call
+        template < typename Event >
+        registry& enqueue_event(Event&& event);
+
+        // drains every event queue, handing each interested system its
+        // whole batch at once; events enqueued by handlers mid-dispatch
+        // join the next pass, so handlers that always re-enqueue never
+        // let the call return
+        registry& dispatch_events();
+
+        template < typename T, typename F >
+        registry& on_construct(F&& f);
+
+        template < typename T, typename F >
+        registry& on_destroy(F&& f);
+
+        registry& batch_signals(bool enabled = true);
+        registry& flush_signals();
+
+        registry& flush(command_buffer& commands);
+
         struct memory_usage_info {
             std::size_t entities{0u};
             std::size_t components{0u};
@@ -1489,6 +2786,17 @@ namespace ecs_hpp
 
         template < typename T >
         std::size_t component_memory_usage() const noexcept;
+
+        // zeros unless built with ECS_HPP_ENABLE_STATS
+        struct stats_info {
+            std::uint64_t component_inserts{0u};
+            std::uint64_t component_erases{0u};
+            std::uint64_t component_probe_misses{0u};
+            std::uint64_t join_entities_visited{0u};
+            std::uint64_t join_entities_matched{0u};
+        };
+        stats_info stats() const noexcept;
+        registry& reset_stats() noexcept;
     private:
         template < typename T >
         detail::component_storage<T>* find_storage_() noexcept;
@@ -1499,87 +2807,174 @@ namespace ecs_hpp
         template < typename T >
         detail::component_storage<T>& get_or_create_storage_();
 
-        template < typename F, typename... Opts >
+        template < typename Event >
+        detail::typed_event_queue<Event>& get_or_create_event_queue_();
+
+        void notify_groups_on_assign_(family_id family, entity_id id) noexcept;
+        void notify_groups_on_remove_(family_id family, entity_id id) noexcept;
+        void notify_groups_on_remove_all_(entity_id id) noexcept;
+        void notify_groups_on_clear_(family_id family) noexcept;
+        void throw_if_group_owned_(family_id family) const;
+
+        template < typename T, typename Writer >
+        void snapshot_storage_(Writer& writer) const;
+        template < typename T, typename Reader >
+        void restore_storage_(Reader& reader);
+
+        void signal_construct_(family_id family, entity_id id);
+        void signal_destroy_(family_id family, entity_id id);
+        void signal_clone_(entity_id id);
+
+        void ensure_signature_(entity_id id);
+        void copy_signature_(entity_id from, entity_id to);
+        void set_signature_bit_(entity_id id, family_id family) noexcept;
+        void clear_signature_bit_(entity_id id, family_id family) noexcept;
+        void clear_signature_(entity_id id) noexcept;
+        bool test_signature_bit_(entity_id id, family_id family) const noexcept;
+
+        template < typename T
+                 , typename... Ts
+                 , typename F
+                 , typename... Opts >
         void for_joined_components_impl_(
-            std::index_sequence<>,
+            const std::tuple<
+                detail::component_storage<T>*,
+                detail::component_storage<Ts>*...>& ss,
             F&& f,
             Opts&&... opts);
 
-        template < typename F, typename... Opts >
+        template < typename T
+                 , typename... Ts
+                 , typename F
+                 , typename... Opts >
         void for_joined_components_impl_(
-            std::index_sequence<>,
+            const std::tuple<
+                const detail::component_storage<T>*,
+                const detail::component_storage<Ts>*...>& ss,
             F&& f,
             Opts&&... opts) const;
 
-        template < typename T
-                 , typename... Ts
+        template < typename... Ts
                  , typename F
                  , typename... Opts
-                 , std::size_t I
                  , std::size_t... Is >
-        void for_joined_components_impl_(
-            std::index_sequence<I, Is...>,
+        void for_joined_components_lead_impl_(
+            std::index_sequence<Is...>,
+            std::size_t lead,
+            const std::tuple<detail::component_storage<Ts>*...>& ss,
             F&& f,
             Opts&&... opts);
 
-        template < typename T
-                 , typename... Ts
+        template < typename... Ts
                  , typename F
                  , typename... Opts
-                 , std::size_t I
                  , std::size_t... Is >
-        void for_joined_components_impl_(
-            std::index_sequence<I, Is...>,
+        void for_joined_components_lead_impl_(
+            std::index_sequence<Is...>,
+            std::size_t lead,
+            const std::tuple<const detail::component_storage<Ts>*...>& ss,
             F&& f,
             Opts&&... opts) const;
 
-        template < typename T
+        template < std::size_t I
                  , typename... Ts
                  , typename F
-                 , typename Ss
-                 , typename... Cs >
-        void for_joined_components_impl_(
-            const uentity& e,
-            const F& f,
-            const Ss& ss,
-            Cs&... cs);
+                 , typename... Opts >
+        void for_joined_components_drive_impl_(
+            const std::tuple<detail::component_storage<Ts>*...>& ss,
+            F&& f,
+            Opts&&... opts);
 
-        template < typename T
+        template < std::size_t I
                  , typename... Ts
                  , typename F
-                 , typename Ss
-                 , typename... Cs >
-        void for_joined_components_impl_(
-            const const_uentity& e,
-            const F& f,
-            const Ss& ss,
-            const Cs&... cs) const;
+                 , typename... Opts >
+        void for_joined_components_drive_impl_(
+            const std::tuple<const detail::component_storage<Ts>*...>& ss,
+            F&& f,
+            Opts&&... opts) const;
 
-        template < typename F, typename... Cs >
-        void for_joined_components_impl_(
-            const uentity& e,
-            const F& f,
-            const std::tuple<>& ss,
-            Cs&... cs);
+        template < typename... Ts
+                 , typename Executor
+                 , typename F
+                 , typename... Opts
+                 , std::size_t... Is >
+        void for_joined_components_par_lead_impl_(
+            std::index_sequence<Is...>,
+            std::size_t lead,
+            Executor& executor,
+            const std::tuple<detail::component_storage<Ts>*...>& ss,
+            F&& f,
+            Opts&&... opts);
 
-        template < typename F, typename... Cs >
-        void for_joined_components_impl_(
-            const const_uentity& e,
-            const F& f,
-            const std::tuple<>& ss,
-            const Cs&... cs) const;
+        template < std::size_t I
+                 , typename... Ts
+                 , typename Executor
+                 , typename F
+                 , typename... Opts >
+        void for_joined_components_par_drive_impl_(
+            Executor& executor,
+            const std::tuple<detail::component_storage<Ts>*...>& ss,
+            F&& f,
+            Opts&&... opts);
+        template < typename... Ts >
+        friend class compiled_aspect;
+
+        template < typename... Ts >
+        friend class view;
+
+        template < typename... Ts >
+        friend class group;
     private:
         entity_id last_entity_id_{0u};
-        std::vector<entity_id> free_entity_ids_;
+
+        // entity slots are indexed by entity index minus one;
+        // a live slot holds its own entity id, a dead slot holds
+        // the next free index in its index bits and the upgraded
+        // version to reuse in its version bits (implicit free list,
+        // zero index means the end of the list)
+        entity_id free_entity_head_{0u};
+        std::vector<entity_id> entity_slots_;
 
         mutable detail::incremental_locker entity_ids_locker_;
         detail::sparse_set<entity_id, detail::entity_id_indexer> entity_ids_;
 
+        static constexpr std::size_t signature_words_ = 4u;
+        static constexpr std::size_t signature_bits_ = signature_words_ * 64u;
+        using signature_t = std::array<std::uint64_t, signature_words_>;
+        std::vector<signature_t> signatures_;
+
         using storage_uptr = std::unique_ptr<detail::component_storage_base>;
+        std::size_t storages_epoch_{0u};
         detail::sparse_map<family_id, storage_uptr> storages_;
 
+        using group_uptr = std::unique_ptr<detail::group_base>;
+        detail::sparse_map<family_id, group_uptr> groups_;
+
+        using signal_listener = std::function<void(registry&, entity_id)>;
+        using signal_listeners = std::vector<signal_listener>;
+
+        struct pending_signal {
+            family_id family{0u};
+            entity_id id{0u};
+            bool construct{false};
+        };
+
+        bool batched_signals_{false};
+        std::vector<pending_signal> pending_signals_;
+        detail::sparse_map<family_id, signal_listeners> construct_signals_;
+        detail::sparse_map<family_id, signal_listeners> destroy_signals_;
+
         mutable detail::incremental_locker features_locker_;
         detail::sparse_map<family_id, feature> features_;
+
+        using event_queue_uptr = std::unique_ptr<detail::event_queue_base>;
+        detail::sparse_map<family_id, event_queue_uptr> event_queues_;
+
+    #if defined(ECS_HPP_ENABLE_STATS)
+        mutable std::uint64_t join_entities_visited_{0u};
+        mutable std::uint64_t join_entities_matched_{0u};
+    #endif
     };
 }
 
@@ -1761,6 +3156,10 @@ namespace ecs_hpp
             return (... && e.exists_component<Ts>());
         }
 
+        static std::size_t count(const registry& owner) noexcept {
+            return compiled_aspect<Ts...>{owner}.count();
+        }
+
         template < typename F, typename... Opts >
         static void for_each_entity(registry& owner, F&& f, Opts&&... opts) {
             owner.for_joined_components<Ts...>(
@@ -1791,260 +3190,770 @@ namespace ecs_hpp
                 std::forward<Opts>(opts)...);
         }
     };
+
+    // an aspect bound to a registry that snapshots the component
+    // storage pointers once, so matching many candidate entities
+    // doesn't re-resolve the storages per entity; matches are a single
+    // signature mask test when all the families fit in the signature,
+    // with direct sparse probes as the fallback
+    template < typename... Ts >
+    class compiled_aspect final {
+        static_assert(
+            sizeof...(Ts) > 0u,
+            "ecs_hpp (at least one component type is required for a compiled aspect)");
+    public:
+        explicit compiled_aspect(const registry& owner) noexcept;
+
+        compiled_aspect(const compiled_aspect&) = default;
+        compiled_aspect& operator=(const compiled_aspect&) = default;
+
+        compiled_aspect(compiled_aspect&&) noexcept = default;
+        compiled_aspect& operator=(compiled_aspect&&) noexcept = default;
+
+        const registry& owner() const noexcept;
+
+        bool match_entity(entity_id id) const noexcept;
+        std::size_t count() const noexcept;
+    private:
+        bool refresh_() const noexcept;
+
+        template < std::size_t... Is >
+        std::size_t count_impl_(std::index_sequence<Is...>, std::size_t lead) const noexcept;
+    private:
+        const registry* owner_{nullptr};
+        bool mask_usable_{false};
+        registry::signature_t mask_{};
+        mutable std::size_t epoch_{std::size_t(-1)};
+        mutable std::tuple<const detail::component_storage<Ts>*...> storages_{};
+    };
 }
 
 // -----------------------------------------------------------------------------
 //
-// fillers
+// view
 //
 // -----------------------------------------------------------------------------
 
 namespace ecs_hpp
 {
-    class entity_filler final {
+    template < typename... Ts >
+    class view final {
+        static_assert(
+            sizeof...(Ts) > 0u,
+            "ecs_hpp (at least one component type is required for a view)");
     public:
-        entity_filler(entity& entity) noexcept
-        : entity_(entity) {}
+        explicit view(registry& owner) noexcept;
 
-        template < typename T, typename... Args >
-        entity_filler& component(Args&&... args) {
-            entity_.assign_component<T>(std::forward<Args>(args)...);
-            return *this;
+        view(const view&) = default;
+        view& operator=(const view&) = default;
+
+        view(view&&) noexcept = default;
+        view& operator=(view&&) noexcept = default;
+
+        registry& owner() noexcept;
+        const registry& owner() const noexcept;
+
+        template < typename F, typename... Opts >
+        void for_each_entity(F&& f, Opts&&... opts);
+
+        template < typename F, typename... Opts >
+        void for_joined_components(F&& f, Opts&&... opts);
+    private:
+        bool refresh_() noexcept;
+    private:
+        registry* owner_{nullptr};
+        std::size_t epoch_{std::size_t(-1)};
+        std::tuple<detail::component_storage<Ts>*...> storages_{};
+    };
+}
+
+// -----------------------------------------------------------------------------
+//
+// raw_view
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    template < typename T >
+    class raw_view final {
+        static_assert(
+            !std::is_empty_v<T>,
+            "ecs_hpp (raw views are not available for empty components)");
+    public:
+        raw_view() = default;
+        raw_view(const entity_id* ids, T* components, std::size_t size) noexcept
+        : ids_(ids)
+        , components_(components)
+        , size_(size) {}
+
+        const entity_id* ids() const noexcept {
+            return ids_;
+        }
+
+        T* components() const noexcept {
+            return components_;
+        }
+
+        bool empty() const noexcept {
+            return !size_;
+        }
+
+        std::size_t size() const noexcept {
+            return size_;
         }
     private:
-        entity& entity_;
+        const entity_id* ids_{nullptr};
+        T* components_{nullptr};
+        std::size_t size_{0u};
     };
 
-    class registry_filler final {
+    template < typename T >
+    class const_raw_view final {
+        static_assert(
+            !std::is_empty_v<T>,
+            "ecs_hpp (raw views are not available for empty components)");
     public:
-        registry_filler(registry& registry) noexcept
-        : registry_(registry) {}
+        const_raw_view() = default;
+        const_raw_view(const entity_id* ids, const T* components, std::size_t size) noexcept
+        : ids_(ids)
+        , components_(components)
+        , size_(size) {}
+
+        const entity_id* ids() const noexcept {
+            return ids_;
+        }
 
-        template < typename Tag, typename... Args >
-        registry_filler& feature(Args&&... args) {
-            registry_.assign_feature<Tag>(std::forward<Args>(args)...);
-            return *this;
+        const T* components() const noexcept {
+            return components_;
+        }
+
+        bool empty() const noexcept {
+            return !size_;
+        }
+
+        std::size_t size() const noexcept {
+            return size_;
         }
     private:
-        registry& registry_;
+        const entity_id* ids_{nullptr};
+        const T* components_{nullptr};
+        std::size_t size_{0u};
     };
 }
 
 // -----------------------------------------------------------------------------
 //
-// entity impl
+// group
 //
 // -----------------------------------------------------------------------------
 
 namespace ecs_hpp
 {
-    inline entity::entity(registry& owner) noexcept
-    : owner_(&owner) {}
+    template < typename... Ts >
+    class group final : public detail::group_base {
+        static_assert(
+            sizeof...(Ts) > 0u,
+            "ecs_hpp (at least one component type is required for a group)");
+    public:
+        explicit group(registry& owner);
 
-    inline entity::entity(registry& owner, entity_id id) noexcept
-    : owner_(&owner)
-    , id_(id) {}
+        group(const group&) = delete;
+        group& operator=(const group&) = delete;
 
-    inline registry& entity::owner() noexcept {
-        return *owner_;
-    }
+        registry& owner() noexcept;
+        const registry& owner() const noexcept;
 
-    inline const registry& entity::owner() const noexcept {
-        return *owner_;
-    }
+        bool empty() const noexcept;
+        std::size_t size() const noexcept;
 
-    inline entity_id entity::id() const noexcept {
-        return id_;
-    }
+        template < typename F >
+        void for_each_entity(F&& f);
 
-    inline entity entity::clone() const {
-        return (*owner_).create_entity(id_);
-    }
+        template < typename F >
+        void for_joined_components(F&& f);
 
-    inline void entity::destroy() noexcept {
-        (*owner_).destroy_entity(id_);
-    }
+        // direct SoA access to the group's aligned storage prefix: the
+        // first size() entries of every owned storage share one entity
+        // ordering, so a multi-component extraction pass reads each
+        // component array linearly and in lockstep, the closest this
+        // layout gets to archetype chunks
+        template < typename T >
+        ecs_hpp::raw_view<T> raw_view() noexcept;
+        template < typename T >
+        ecs_hpp::const_raw_view<T> raw_view() const noexcept;
 
-    inline bool entity::valid() const noexcept {
-        return std::as_const(*owner_).valid_entity(id_);
-    }
+        bool owns(family_id family) const noexcept override;
+        void on_assign(entity_id id) noexcept override;
+        void on_remove(entity_id id) noexcept override;
+        void on_remove_all() noexcept override;
+    private:
+        bool is_member_(entity_id id) const noexcept;
+    private:
+        registry* owner_{nullptr};
+        std::size_t size_{0u};
+        std::tuple<detail::component_storage<Ts>*...> storages_{};
+    };
+}
 
-    template < typename T, typename... Args >
-    T& entity::assign_component(Args&&... args) {
-        return (*owner_).assign_component<T>(
-            id_,
-            std::forward<Args>(args)...);
-    }
+// -----------------------------------------------------------------------------
+//
+// command_buffer
+//
+// -----------------------------------------------------------------------------
 
-    template < typename T, typename... Args >
-    T& entity::ensure_component(Args&&... args) {
-        return (*owner_).ensure_component<T>(
-            id_,
-            std::forward<Args>(args)...);
-    }
+namespace ecs_hpp
+{
+    class command_buffer final {
+    public:
+        command_buffer() = default;
+        ~command_buffer() noexcept;
 
-    template < typename T >
-    bool entity::remove_component() noexcept {
-        return (*owner_).remove_component<T>(id_);
-    }
+        command_buffer(const command_buffer&) = delete;
+        command_buffer& operator=(const command_buffer&) = delete;
 
-    template < typename T >
-    bool entity::exists_component() const noexcept {
-        return std::as_const(*owner_).exists_component<T>(id_);
-    }
+        command_buffer(command_buffer&& other) noexcept;
+        command_buffer& operator=(command_buffer&& other) noexcept;
 
-    inline std::size_t entity::remove_all_components() noexcept {
-        return (*owner_).remove_all_components(id_);
-    }
+        command_buffer& create_entity(prototype proto);
+        command_buffer& destroy_entity(const entity& ent);
 
-    template < typename T >
-    T& entity::get_component() {
-        return (*owner_).get_component<T>(id_);
-    }
+        template < typename T, typename... Args >
+        command_buffer& assign_component(const entity& ent, Args&&... args);
 
-    template < typename T >
-    const T& entity::get_component() const {
-        return std::as_const(*owner_).get_component<T>(id_);
-    }
+        template < typename T, typename... Args >
+        command_buffer& ensure_component(const entity& ent, Args&&... args);
 
-    template < typename T >
-    T* entity::find_component() noexcept {
-        return (*owner_).find_component<T>(id_);
-    }
+        template < typename T >
+        command_buffer& remove_component(const entity& ent);
 
-    template < typename T >
-    const T* entity::find_component() const noexcept {
-        return std::as_const(*owner_).find_component<T>(id_);
-    }
+        command_buffer& remove_all_components(const entity& ent);
 
-    template < typename... Ts >
-    std::tuple<Ts&...> entity::get_components() {
-        return (*owner_).get_components<Ts...>(id_);
-    }
+        bool empty() const noexcept;
+        std::size_t size() const noexcept;
+        void clear() noexcept;
+    private:
+        class op_base {
+        public:
+            virtual ~op_base() = default;
+            virtual void apply(registry& owner) = 0;
+        public:
+            op_base* next{nullptr};
+        };
 
-    template < typename... Ts >
-    std::tuple<const Ts&...> entity::get_components() const {
-        return std::as_const(*owner_).get_components<Ts...>(id_);
-    }
+        template < typename F >
+        class op_impl final : public op_base {
+        public:
+            op_impl(F&& f)
+            : f_(std::move(f)) {}
 
-    template < typename... Ts >
-    std::tuple<Ts*...> entity::find_components() noexcept {
-        return (*owner_).find_components<Ts...>(id_);
-    }
+            void apply(registry& owner) override {
+                f_(owner);
+            }
+        private:
+            F f_;
+        };
 
-    template < typename... Ts >
-    std::tuple<const Ts*...> entity::find_components() const noexcept {
-        return std::as_const(*owner_).find_components<Ts...>(id_);
-    }
+        struct chunk {
+            std::unique_ptr<std::byte[]> memory;
+            std::size_t capacity{0u};
+            std::size_t offset{0u};
+        };
+    private:
+        friend class registry;
+        void apply_(registry& owner);
 
-    inline std::size_t entity::component_count() const noexcept {
-        return std::as_const(*owner_).entity_component_count(id_);
-    }
+        template < typename F >
+        void push_op_(F&& f);
+        void* allocate_(std::size_t size, std::size_t align);
+    private:
+        static constexpr std::size_t chunk_capacity = 4096u;
+        std::vector<chunk> chunks_;
+        std::size_t active_chunk_{0u};
+        op_base* head_{nullptr};
+        op_base* tail_{nullptr};
+        std::size_t op_count_{0u};
+    };
+}
 
-    inline bool operator<(const entity& l, const entity& r) noexcept {
-        return (&l.owner() < &r.owner())
-            || (&l.owner() == &r.owner() && l.id() < r.id());
-    }
+// -----------------------------------------------------------------------------
+//
+// registry_t
+//
+// -----------------------------------------------------------------------------
 
-    inline bool operator==(const entity& l, const entity& r) noexcept {
-        return &l.owner() == &r.owner()
-            && l.id() == r.id();
-    }
+namespace ecs_hpp
+{
+    template < typename... Ts >
+    struct components final {};
 
-    inline bool operator==(const entity& l, const const_entity& r) noexcept {
-        return &l.owner() == &r.owner()
-            && l.id() == r.id();
-    }
+    namespace detail
+    {
+        template < typename T, typename... Ts >
+        struct component_type_index;
 
-    inline bool operator!=(const entity& l, const entity& r) noexcept {
-        return !(l == r);
-    }
+        template < typename T, typename... Ts >
+        struct component_type_index<T, T, Ts...>
+        : std::integral_constant<std::size_t, 0u> {};
 
-    inline bool operator!=(const entity& l, const const_entity& r) noexcept {
-        return !(l == r);
+        template < typename T, typename U, typename... Ts >
+        struct component_type_index<T, U, Ts...>
+        : std::integral_constant<std::size_t,
+            1u + component_type_index<T, Ts...>::value> {};
+
+        template < typename T, typename... Ts >
+        inline constexpr std::size_t component_type_index_v =
+            component_type_index<T, Ts...>::value;
     }
+
+    template < typename ComponentList >
+    class registry_t;
+
+    template < typename... Cs >
+    class registry_t<components<Cs...>> final {
+    public:
+        registry_t()
+        : storages_(detail::component_storage<Cs>(ids_)...) {}
+
+        ~registry_t() noexcept = default;
+
+        registry_t(const registry_t& other) = delete;
+        registry_t& operator=(const registry_t& other) = delete;
+
+        entity_id create_entity() {
+            return ids_.create_entity().id();
+        }
+
+        entity_id create_entity(entity_id proto) {
+            assert(valid_entity(proto));
+            const entity_id id = create_entity();
+            try {
+                (... , storage_<Cs>().clone(proto, id));
+            } catch (...) {
+                destroy_entity(id);
+                throw;
+            }
+            return id;
+        }
+
+        void destroy_entity(entity_id id) noexcept {
+            remove_all_components(id);
+            ids_.destroy_entity(id);
+        }
+
+        bool valid_entity(entity_id id) const noexcept {
+            return ids_.valid_entity(id);
+        }
+
+        template < typename T, typename... Args >
+        T& assign_component(entity_id id, Args&&... args) {
+            assert(valid_entity(id));
+            return storage_<T>().assign(id, std::forward<Args>(args)...);
+        }
+
+        template < typename T, typename... Args >
+        T& ensure_component(entity_id id, Args&&... args) {
+            assert(valid_entity(id));
+            return storage_<T>().ensure(id, std::forward<Args>(args)...);
+        }
+
+        template < typename T >
+        bool remove_component(entity_id id) noexcept {
+            assert(valid_entity(id));
+            return storage_<T>().remove(id);
+        }
+
+        template < typename T >
+        bool exists_component(entity_id id) const noexcept {
+            assert(valid_entity(id));
+            return storage_<T>().exists(id);
+        }
+
+        std::size_t remove_all_components(entity_id id) noexcept {
+            std::size_t removed_count = 0u;
+            (... , (removed_count += storage_<Cs>().remove(id) ? 1u : 0u));
+            return removed_count;
+        }
+
+        template < typename T >
+        std::size_t remove_all_components() noexcept {
+            return storage_<T>().remove_all();
+        }
+
+        template < typename T >
+        T& get_component(entity_id id) {
+            if ( T* component = find_component<T>(id) ) {
+                return *component;
+            }
+            throw std::logic_error("ecs_hpp::registry_t (component not found)");
+        }
+
+        template < typename T >
+        const T& get_component(entity_id id) const {
+            if ( const T* component = find_component<T>(id) ) {
+                return *component;
+            }
+            throw std::logic_error("ecs_hpp::registry_t (component not found)");
+        }
+
+        template < typename T >
+        T* find_component(entity_id id) noexcept {
+            assert(valid_entity(id));
+            return storage_<T>().find(id);
+        }
+
+        template < typename T >
+        const T* find_component(entity_id id) const noexcept {
+            assert(valid_entity(id));
+            return storage_<T>().find(id);
+        }
+
+        template < typename T >
+        std::size_t component_count() const noexcept {
+            return storage_<T>().count();
+        }
+
+        std::size_t entity_count() const noexcept {
+            return ids_.entity_count();
+        }
+
+        void reserve_entities(std::size_t count) {
+            ids_.reserve_entities(count);
+        }
+
+        template < typename T >
+        void reserve(std::size_t count) {
+            storage_<T>().reserve(count);
+        }
+
+        template < typename T, typename F >
+        void for_each_component(F&& f) {
+            storage_<T>().for_each_component(f);
+        }
+
+        template < typename T, typename F >
+        void for_each_component(F&& f) const {
+            storage_<T>().for_each_component(f);
+        }
+
+        template < typename T, typename... Ts, typename F >
+        void for_joined_components(F&& f) {
+            storage_<T>().for_each_component([this, &f](const entity_id e, T& t){
+                if ( const auto cs = std::make_tuple(storage_<Ts>().find(e)...);
+                     !detail::tuple_contains(cs, nullptr) )
+                {
+                    std::apply([&f, e, &t](auto*... components){
+                        f(e, t, *components...);
+                    }, cs);
+                }
+            });
+        }
+
+        template < typename T, typename... Ts, typename F >
+        void for_joined_components(F&& f) const {
+            storage_<T>().for_each_component([this, &f](const entity_id e, const T& t){
+                if ( const auto cs = std::make_tuple(storage_<Ts>().find(e)...);
+                     !detail::tuple_contains(cs, nullptr) )
+                {
+                    std::apply([&f, e, &t](const auto*... components){
+                        f(e, t, *components...);
+                    }, cs);
+                }
+            });
+        }
+    private:
+        template < typename T >
+        detail::component_storage<T>& storage_() noexcept {
+            static_assert(
+                (... || std::is_same_v<T, Cs>),
+                "component type is not listed in the registry components");
+            return std::get<detail::component_type_index_v<T, Cs...>>(storages_);
+        }
+
+        template < typename T >
+        const detail::component_storage<T>& storage_() const noexcept {
+            static_assert(
+                (... || std::is_same_v<T, Cs>),
+                "component type is not listed in the registry components");
+            return std::get<detail::component_type_index_v<T, Cs...>>(storages_);
+        }
+    private:
+        registry ids_;
+        std::tuple<detail::component_storage<Cs>...> storages_;
+    };
 }
 
 // -----------------------------------------------------------------------------
 //
-// const_entity impl
+// fillers
 //
 // -----------------------------------------------------------------------------
 
 namespace ecs_hpp
 {
-    inline const_entity::const_entity(const entity& ent) noexcept
-    : owner_(&ent.owner())
-    , id_(ent.id()) {}
+    class entity_filler final {
+    public:
+        entity_filler(entity& entity) noexcept
+        : entity_(entity) {}
 
-    inline const_entity::const_entity(const registry& owner) noexcept
+        template < typename T, typename... Args >
+        entity_filler& component(Args&&... args) {
+            entity_.assign_component<T>(std::forward<Args>(args)...);
+            return *this;
+        }
+    private:
+        entity& entity_;
+    };
+
+    class registry_filler final {
+    public:
+        registry_filler(registry& registry) noexcept
+        : registry_(registry) {}
+
+        template < typename Tag, typename... Args >
+        registry_filler& feature(Args&&... args) {
+            registry_.assign_feature<Tag>(std::forward<Args>(args)...);
+            return *this;
+        }
+    private:
+        registry& registry_;
+    };
+}
+
+// -----------------------------------------------------------------------------
+//
+// entity impl
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    inline entity::entity(registry& owner) noexcept
     : owner_(&owner) {}
 
-    inline const_entity::const_entity(const registry& owner, entity_id id) noexcept
+    inline entity::entity(registry& owner, entity_id id) noexcept
     : owner_(&owner)
     , id_(id) {}
 
-    inline const registry& const_entity::owner() const noexcept {
+    inline registry& entity::owner() noexcept {
         return *owner_;
     }
 
-    inline entity_id const_entity::id() const noexcept {
+    inline const registry& entity::owner() const noexcept {
+        return *owner_;
+    }
+
+    inline entity_id entity::id() const noexcept {
         return id_;
     }
 
-    inline bool const_entity::valid() const noexcept {
-        return (*owner_).valid_entity(id_);
+    inline entity entity::clone() const {
+        return (*owner_).create_entity(id_);
+    }
+
+    inline void entity::destroy() noexcept {
+        (*owner_).destroy_entity(id_);
+    }
+
+    inline bool entity::valid() const noexcept {
+        return std::as_const(*owner_).valid_entity(id_);
+    }
+
+    template < typename T, typename... Args >
+    T& entity::assign_component(Args&&... args) {
+        return (*owner_).assign_component<T>(
+            id_,
+            std::forward<Args>(args)...);
+    }
+
+    template < typename T, typename... Args >
+    T& entity::emplace_component(Args&&... args) {
+        return (*owner_).emplace_component<T>(
+            id_,
+            std::forward<Args>(args)...);
+    }
+
+    template < typename T, typename... Args >
+    T& entity::ensure_component(Args&&... args) {
+        return (*owner_).ensure_component<T>(
+            id_,
+            std::forward<Args>(args)...);
+    }
+
+    template < typename T, typename F >
+    T& entity::patch_component(F&& f) {
+        return (*owner_).patch_component<T>(
+            id_,
+            std::forward<F>(f));
     }
 
     template < typename T >
-    bool const_entity::exists_component() const noexcept {
-        return (*owner_).exists_component<T>(id_);
+    bool entity::remove_component() noexcept {
+        return (*owner_).remove_component<T>(id_);
     }
 
     template < typename T >
-    const T& const_entity::get_component() const {
+    bool entity::exists_component() const noexcept {
+        return std::as_const(*owner_).exists_component<T>(id_);
+    }
+
+    inline std::size_t entity::remove_all_components() noexcept {
+        return (*owner_).remove_all_components(id_);
+    }
+
+    template < typename T >
+    T& entity::get_component() {
         return (*owner_).get_component<T>(id_);
     }
 
     template < typename T >
-    const T* const_entity::find_component() const noexcept {
+    const T& entity::get_component() const {
+        return std::as_const(*owner_).get_component<T>(id_);
+    }
+
+    template < typename T >
+    T* entity::find_component() noexcept {
         return (*owner_).find_component<T>(id_);
     }
 
+    template < typename T >
+    const T* entity::find_component() const noexcept {
+        return std::as_const(*owner_).find_component<T>(id_);
+    }
+
     template < typename... Ts >
-    std::tuple<const Ts&...> const_entity::get_components() const {
+    std::tuple<Ts&...> entity::get_components() {
         return (*owner_).get_components<Ts...>(id_);
     }
 
     template < typename... Ts >
-    std::tuple<const Ts*...> const_entity::find_components() const noexcept {
+    std::tuple<const Ts&...> entity::get_components() const {
+        return std::as_const(*owner_).get_components<Ts...>(id_);
+    }
+
+    template < typename... Ts >
+    std::tuple<Ts*...> entity::find_components() noexcept {
         return (*owner_).find_components<Ts...>(id_);
     }
 
-    inline std::size_t const_entity::component_count() const noexcept {
-        return (*owner_).entity_component_count(id_);
+    template < typename... Ts >
+    std::tuple<const Ts*...> entity::find_components() const noexcept {
+        return std::as_const(*owner_).find_components<Ts...>(id_);
     }
 
-    inline bool operator<(const const_entity& l, const const_entity& r) noexcept {
+    template < typename... Ts >
+    std::tuple<Ts&...> entity::get_or_assign_components() {
+        return (*owner_).get_or_assign_components<Ts...>(id_);
+    }
+
+    inline std::size_t entity::component_count() const noexcept {
+        return std::as_const(*owner_).entity_component_count(id_);
+    }
+
+    inline bool operator<(const entity& l, const entity& r) noexcept {
         return (&l.owner() < &r.owner())
             || (&l.owner() == &r.owner() && l.id() < r.id());
     }
 
-    inline bool operator==(const const_entity& l, const entity& r) noexcept {
+    inline bool operator==(const entity& l, const entity& r) noexcept {
         return &l.owner() == &r.owner()
             && l.id() == r.id();
     }
 
-    inline bool operator==(const const_entity& l, const const_entity& r) noexcept {
+    inline bool operator==(const entity& l, const const_entity& r) noexcept {
         return &l.owner() == &r.owner()
             && l.id() == r.id();
     }
 
-    inline bool operator!=(const const_entity& l, const entity& r) noexcept {
+    inline bool operator!=(const entity& l, const entity& r) noexcept {
         return !(l == r);
     }
 
-    inline bool operator!=(const const_entity& l, const const_entity& r) noexcept {
+    inline bool operator!=(const entity& l, const const_entity& r) noexcept {
+        return !(l == r);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// const_entity impl
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    inline const_entity::const_entity(const entity& ent) noexcept
+    : owner_(&ent.owner())
+    , id_(ent.id()) {}
+
+    inline const_entity::const_entity(const registry& owner) noexcept
+    : owner_(&owner) {}
+
+    inline const_entity::const_entity(const registry& owner, entity_id id) noexcept
+    : owner_(&owner)
+    , id_(id) {}
+
+    inline const registry& const_entity::owner() const noexcept {
+        return *owner_;
+    }
+
+    inline entity_id const_entity::id() const noexcept {
+        return id_;
+    }
+
+    inline bool const_entity::valid() const noexcept {
+        return (*owner_).valid_entity(id_);
+    }
+
+    template < typename T >
+    bool const_entity::exists_component() const noexcept {
+        return (*owner_).exists_component<T>(id_);
+    }
+
+    template < typename T >
+    const T& const_entity::get_component() const {
+        return (*owner_).get_component<T>(id_);
+    }
+
+    template < typename T >
+    const T* const_entity::find_component() const noexcept {
+        return (*owner_).find_component<T>(id_);
+    }
+
+    template < typename... Ts >
+    std::tuple<const Ts&...> const_entity::get_components() const {
+        return (*owner_).get_components<Ts...>(id_);
+    }
+
+    template < typename... Ts >
+    std::tuple<const Ts*...> const_entity::find_components() const noexcept {
+        return (*owner_).find_components<Ts...>(id_);
+    }
+
+    inline std::size_t const_entity::component_count() const noexcept {
+        return (*owner_).entity_component_count(id_);
+    }
+
+    inline bool operator<(const const_entity& l, const const_entity& r) noexcept {
+        return (&l.owner() < &r.owner())
+            || (&l.owner() == &r.owner() && l.id() < r.id());
+    }
+
+    inline bool operator==(const const_entity& l, const entity& r) noexcept {
+        return &l.owner() == &r.owner()
+            && l.id() == r.id();
+    }
+
+    inline bool operator==(const const_entity& l, const const_entity& r) noexcept {
+        return &l.owner() == &r.owner()
+            && l.id() == r.id();
+    }
+
+    inline bool operator!=(const const_entity& l, const entity& r) noexcept {
+        return !(l == r);
+    }
+
+    inline bool operator!=(const const_entity& l, const const_entity& r) noexcept {
         return !(l == r);
     }
 }
@@ -2269,11 +4178,6 @@ namespace ecs_hpp
         typed_applier_with_args<T, Args...>::typed_applier_with_args(const std::tuple<Args...>& args)
         : args_(args) {}
 
-        template < typename T, typename... Args >
-        applier_uptr typed_applier_with_args<T, Args...>::clone() const {
-            return std::make_unique<typed_applier_with_args>(args_);
-        }
-
         template < typename T, typename... Args >
         void typed_applier_with_args<T, Args...>::apply_to_entity(entity& ent, bool override) const {
             std::apply([&ent, override](const Args&... args){
@@ -2283,6 +4187,13 @@ namespace ecs_hpp
             }, args_);
         }
 
+        template < typename T, typename... Args >
+        void typed_applier_with_args<T, Args...>::bake_into(baked_prototype& baked) const {
+            std::apply([&baked](const Args&... args){
+                baked.component<T>(T{args...});
+            }, args_);
+        }
+
         template < typename T, typename... Args >
         void typed_applier_with_args<T, Args...>::apply_to_component(T& component) const {
             std::apply([&component](const Args&... args){
@@ -2293,7 +4204,10 @@ namespace ecs_hpp
 
     inline prototype::prototype(const prototype& other) {
         for ( const family_id family : other.appliers_ ) {
-            appliers_.insert(family, other.appliers_.get(family)->clone());
+            const std::size_t index = other.appliers_buffer_.clone_into(
+                other.appliers_.get(family),
+                appliers_buffer_);
+            appliers_.insert(family, index);
         }
     }
 
@@ -2306,7 +4220,8 @@ namespace ecs_hpp
     }
 
     inline prototype::prototype(prototype&& other) noexcept
-    : appliers_(std::move(other.appliers_)) {}
+    : appliers_(std::move(other.appliers_))
+    , appliers_buffer_(std::move(other.appliers_buffer_)) {}
 
     inline prototype& prototype::operator=(prototype&& other) noexcept {
         if ( this != &other ) {
@@ -2318,6 +4233,7 @@ namespace ecs_hpp
 
     inline void prototype::clear() noexcept {
         appliers_.clear();
+        appliers_buffer_.clear();
     }
 
     inline bool prototype::empty() const noexcept {
@@ -2327,6 +4243,7 @@ namespace ecs_hpp
     inline void prototype::swap(prototype& other) noexcept {
         using std::swap;
         swap(appliers_, other.appliers_);
+        appliers_buffer_.swap(other.appliers_buffer_);
     }
 
     template < typename T >
@@ -2340,10 +4257,9 @@ namespace ecs_hpp
         using applier_t = detail::typed_applier_with_args<
             T,
             std::decay_t<Args>...>;
-        auto applier = std::make_unique<applier_t>(
+        const std::size_t index = appliers_buffer_.emplace<applier_t>(
             std::make_tuple(std::forward<Args>(args)...));
-        const auto family = detail::type_family<T>::id();
-        appliers_.insert_or_assign(family, std::move(applier));
+        set_applier_(detail::type_family<T>::id(), index);
         return *this;
     }
 
@@ -2356,9 +4272,10 @@ namespace ecs_hpp
     inline prototype& prototype::merge_with(const prototype& other, bool override) & {
         for ( const auto family : other.appliers_ ) {
             if ( override || !appliers_.has(family) ) {
-                appliers_.insert_or_assign(
-                    family,
-                    other.appliers_.get(family)->clone());
+                const std::size_t index = other.appliers_buffer_.clone_into(
+                    other.appliers_.get(family),
+                    appliers_buffer_);
+                set_applier_(family, index);
             }
         }
         return *this;
@@ -2372,25 +4289,144 @@ namespace ecs_hpp
     template < typename T >
     bool prototype::apply_to_component(T& component) const {
         const auto family = detail::type_family<T>::id();
-        const auto applier_base_ptr = appliers_.find(family);
-        if ( !applier_base_ptr ) {
+        const auto index_ptr = appliers_.find(family);
+        if ( !index_ptr ) {
             return false;
         }
         using applier_t = detail::typed_applier<T>;
-        const auto applier = static_cast<applier_t*>(applier_base_ptr->get());
-        applier->apply_to_component(component);
+        const auto& applier = static_cast<const applier_t&>(
+            appliers_buffer_[*index_ptr]);
+        applier.apply_to_component(component);
         return true;
     }
 
     inline void prototype::apply_to_entity(entity& ent, bool override) const {
         for ( const auto family : appliers_ ) {
-            appliers_.get(family)->apply_to_entity(ent, override);
+            appliers_buffer_[appliers_.get(family)].apply_to_entity(ent, override);
+        }
+    }
+
+    template < typename Iterator >
+    void prototype::apply_to_entities(Iterator first, Iterator last, bool override) const {
+        for ( const auto family : appliers_ ) {
+            const detail::applier_base& applier = appliers_buffer_[appliers_.get(family)];
+            for ( Iterator iter = first; iter != last; ++iter ) {
+                applier.apply_to_entity(*iter, override);
+            }
+        }
+    }
+
+    inline void prototype::set_applier_(family_id family, std::size_t index) {
+        if ( std::size_t* old_index = appliers_.find(family) ) {
+            appliers_buffer_.destroy_at(*old_index);
+            *old_index = index;
+        } else {
+            try {
+                appliers_.insert(family, index);
+            } catch (...) {
+                appliers_buffer_.destroy_at(index);
+                throw;
+            }
         }
     }
 
     inline void swap(prototype& l, prototype& r) noexcept {
         l.swap(r);
     }
+
+    inline void prototype::bake_into(baked_prototype& baked) const {
+        for ( const auto family : appliers_ ) {
+            appliers_buffer_[appliers_.get(family)].bake_into(baked);
+        }
+    }
+
+    inline baked_prototype::baked_prototype(const prototype& proto) {
+        proto.bake_into(*this);
+    }
+
+    inline void baked_prototype::clear() noexcept {
+        blob_.clear();
+        ops_.clear();
+        fallback_.clear();
+    }
+
+    inline bool baked_prototype::empty() const noexcept {
+        return ops_.empty() && fallback_.empty();
+    }
+
+    inline void baked_prototype::swap(baked_prototype& other) noexcept {
+        using std::swap;
+        swap(blob_, other.blob_);
+        swap(ops_, other.ops_);
+        swap(fallback_, other.fallback_);
+    }
+
+    template < typename T >
+    bool baked_prototype::has_component() const noexcept {
+        const auto family = detail::type_family<T>::id();
+        for ( const baked_op& op : ops_ ) {
+            if ( op.family == family ) {
+                return true;
+            }
+        }
+        return fallback_.has_component<T>();
+    }
+
+    template < typename T >
+    baked_prototype& baked_prototype::component(T value) & {
+        if constexpr ( std::is_trivially_copyable_v<T> ) {
+            const auto family = detail::type_family<T>::id();
+            for ( baked_op& op : ops_ ) {
+                if ( op.family == family ) {
+                    std::memcpy(blob_.data() + op.offset, &value, sizeof(T));
+                    return *this;
+                }
+            }
+            std::size_t offset = blob_.size();
+            if ( const std::size_t rem = offset % alignof(T) ) {
+                offset += alignof(T) - rem;
+            }
+            blob_.resize(offset + sizeof(T));
+            std::memcpy(blob_.data() + offset, &value, sizeof(T));
+            ops_.push_back(baked_op{family, offset, &apply_op_<T>});
+        } else {
+            fallback_.component<T>(std::move(value));
+        }
+        return *this;
+    }
+
+    template < typename T >
+    baked_prototype&& baked_prototype::component(T value) && {
+        component<T>(std::move(value));
+        return std::move(*this);
+    }
+
+    template < typename T >
+    void baked_prototype::apply_op_(entity& ent, const void* value, bool override) {
+        if ( override || !ent.exists_component<T>() ) {
+            ent.assign_component<T>(*static_cast<const T*>(value));
+        }
+    }
+
+    inline void baked_prototype::apply_to_entity(entity& ent, bool override) const {
+        for ( const baked_op& op : ops_ ) {
+            op.apply(ent, blob_.data() + op.offset, override);
+        }
+        if ( !fallback_.empty() ) {
+            fallback_.apply_to_entity(ent, override);
+        }
+    }
+
+    template < typename Iterator >
+    void baked_prototype::apply_to_entities(Iterator first, Iterator last, bool override) const {
+        for ( Iterator iter = first; iter != last; ++iter ) {
+            apply_to_entity(*iter, override);
+        }
+    }
+
+    inline void swap(baked_prototype& l, baked_prototype& r) noexcept {
+        l.swap(r);
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -2432,7 +4468,11 @@ namespace ecs_hpp
     template < typename T, typename... Args >
     feature& feature::add_system(Args&&... args) & {
         assert(!systems_locker_.is_locked());
-        systems_.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        systems_.emplace<T>(std::forward<Args>(args)...);
+        dispatch_cache_.clear();
+    #if defined(ECS_HPP_ENABLE_STATS)
+        system_times_.resize(systems_.size(), 0.0);
+    #endif
         return *this;
     }
 
@@ -2442,24 +4482,218 @@ namespace ecs_hpp
         return std::move(*this);
     }
 
+    inline std::vector<double> feature::system_times() const {
+    #if defined(ECS_HPP_ENABLE_STATS)
+        return system_times_;
+    #else
+        return {};
+    #endif
+    }
+
+    inline feature& feature::reset_stats() noexcept {
+    #if defined(ECS_HPP_ENABLE_STATS)
+        std::fill(system_times_.begin(), system_times_.end(), 0.0);
+    #endif
+        return *this;
+    }
+
     template < typename Event >
     feature& feature::process_event(registry& owner, const Event& event) {
         detail::incremental_lock_guard lock(systems_locker_);
 
-        const auto fire_event = [this, &owner](const auto& event){
-            for ( const auto& base_system : systems_ ) {
-                using system_type = system<std::decay_t<decltype(event)>>;
-                if ( auto event_system = dynamic_cast<system_type*>(base_system.get()) ) {
-                    event_system->process(owner, event);
+        fire_event_(owner, before<Event>{event});
+        fire_event_(owner, event);
+        fire_event_(owner, after<Event>{event});
+
+        return *this;
+    }
+
+    template < typename Event >
+    feature& feature::process_events(registry& owner, const Event* events, std::size_t event_count) {
+        detail::incremental_lock_guard lock(systems_locker_);
+
+        for ( std::size_t i = 0; i < event_count; ++i ) {
+            fire_event_(owner, before<Event>{events[i]});
+        }
+        fire_events_(owner, events, event_count);
+        for ( std::size_t i = 0; i < event_count; ++i ) {
+            fire_event_(owner, after<Event>{events[i]});
+        }
+
+        return *this;
+    }
+
+    template < typename Executor, typename Event >
+    feature& feature::process_event_par(registry& owner, Executor& executor, const Event& event) {
+        detail::incremental_lock_guard lock(systems_locker_);
+
+        fire_event_par_(owner, executor, before<Event>{event});
+        fire_event_par_(owner, executor, event);
+        fire_event_par_(owner, executor, after<Event>{event});
+
+        return *this;
+    }
+
+    template < typename Event >
+    std::vector<void*>& feature::handlers_for_() {
+        using system_type = system<Event>;
+
+        // built once per event type after the last add_system,
+        // so dispatching skips systems without a matching handler
+        const family_id family = detail::type_family<system_type>::id();
+        std::vector<void*>* handlers = dispatch_cache_.find(family);
+        if ( !handlers ) {
+            std::vector<void*> new_handlers;
+            for ( std::size_t i = 0u; i < systems_.size(); ++i ) {
+                if ( auto event_system = dynamic_cast<system_type*>(&systems_[i]) ) {
+                    new_handlers.push_back(event_system);
+                }
+            }
+            handlers = dispatch_cache_.insert(family, std::move(new_handlers)).first;
+        }
+        return *handlers;
+    }
+
+    template < typename Event >
+    void feature::fire_event_(registry& owner, const Event& event) {
+        using system_type = system<Event>;
+    #if defined(ECS_HPP_ENABLE_STATS)
+        // walk all systems instead of the dispatch cache to attribute
+        // the measured time to a stable system index
+        for ( std::size_t i = 0; i < systems_.size(); ++i ) {
+            if ( auto event_system = dynamic_cast<system_type*>(&systems_[i]) ) {
+                const auto begin_time = std::chrono::steady_clock::now();
+                event_system->process(owner, event);
+                const auto end_time = std::chrono::steady_clock::now();
+                system_times_[i] += std::chrono::duration<double>(
+                    end_time - begin_time).count();
+            }
+        }
+    #else
+        for ( void* handler : handlers_for_<Event>() ) {
+            static_cast<system_type*>(handler)->process(owner, event);
+        }
+    #endif
+    }
+
+    template < typename Event >
+    void feature::fire_events_(registry& owner, const Event* events, std::size_t event_count) {
+        using system_type = system<Event>;
+        if ( !event_count ) {
+            return;
+        }
+    #if defined(ECS_HPP_ENABLE_STATS)
+        // walk all systems instead of the dispatch cache to attribute
+        // the measured time to a stable system index
+        for ( std::size_t i = 0; i < systems_.size(); ++i ) {
+            if ( auto event_system = dynamic_cast<system_type*>(&systems_[i]) ) {
+                const auto begin_time = std::chrono::steady_clock::now();
+                event_system->process_batch(owner, events, event_count);
+                const auto end_time = std::chrono::steady_clock::now();
+                system_times_[i] += std::chrono::duration<double>(
+                    end_time - begin_time).count();
+            }
+        }
+    #else
+        for ( void* handler : handlers_for_<Event>() ) {
+            static_cast<system_type*>(handler)->process_batch(owner, events, event_count);
+        }
+    #endif
+    }
+
+    template < typename Executor, typename Event >
+    void feature::fire_event_par_(registry& owner, Executor& executor, const Event& event) {
+        using system_type = system<Event>;
+
+        std::vector<system_type*> wave;
+        std::vector<system_access> wave_access;
+
+        const auto run_wave = [&owner, &executor, &event, &wave, &wave_access](){
+            if ( wave.empty() ) {
+                return;
+            }
+
+            if ( wave.size() == 1u ) {
+                wave.front()->process(owner, event);
+                wave.clear();
+                wave_access.clear();
+                return;
+            }
+
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::size_t remaining_tasks{0u};
+            std::exception_ptr task_exception;
+
+            for ( system_type* event_system : wave ) {
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    ++remaining_tasks;
+                }
+                try {
+                    executor(
+                    [&owner, &event, &mutex, &cv, &remaining_tasks, &task_exception, event_system](){
+                        try {
+                            event_system->process(owner, event);
+                        } catch (...) {
+                            std::lock_guard<std::mutex> guard(mutex);
+                            if ( !task_exception ) {
+                                task_exception = std::current_exception();
+                            }
+                        }
+                        {
+                            std::lock_guard<std::mutex> guard(mutex);
+                            --remaining_tasks;
+                        }
+                        cv.notify_one();
+                    });
+                } catch (...) {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    --remaining_tasks;
+                    if ( !task_exception ) {
+                        task_exception = std::current_exception();
+                    }
                 }
             }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&remaining_tasks]{
+                    return !remaining_tasks;
+                });
+            }
+
+            wave.clear();
+            wave_access.clear();
+
+            if ( task_exception ) {
+                std::rethrow_exception(task_exception);
+            }
         };
 
-        fire_event(before<Event>{event});
-        fire_event(event);
-        fire_event(after<Event>{event});
+        // greedy wave scheduling: systems join the current wave while their
+        // declared component sets stay disjoint; the first conflict closes
+        // the wave, which preserves the relative order of conflicting systems
+        for ( void* handler : handlers_for_<Event>() ) {
+            auto* event_system = static_cast<system_type*>(handler);
+            system_access access = event_system->access();
+
+            bool conflicts = false;
+            for ( const system_access& other : wave_access ) {
+                if ( access.conflicts_with(other) ) {
+                    conflicts = true;
+                    break;
+                }
+            }
 
-        return *this;
+            if ( conflicts ) {
+                run_wave();
+            }
+
+            wave.push_back(event_system);
+            wave_access.push_back(std::move(access));
+        }
+        run_wave();
     }
 }
 
@@ -2584,25 +4818,27 @@ namespace ecs_hpp
 
     inline entity registry::create_entity() {
         assert(!entity_ids_locker_.is_locked());
-        if ( !free_entity_ids_.empty() ) {
-            const auto free_ent_id = free_entity_ids_.back();
-            const auto new_ent_id = detail::upgrade_entity_id(free_ent_id);
+        if ( free_entity_head_ ) {
+            const entity_id free_index = free_entity_head_;
+            const entity_id free_slot = entity_slots_[free_index - 1u];
+            const entity_id new_ent_id = detail::entity_id_join(
+                free_index,
+                detail::entity_id_version(free_slot));
             entity_ids_.insert(new_ent_id);
-            free_entity_ids_.pop_back();
+            free_entity_head_ = detail::entity_id_index(free_slot);
+            entity_slots_[free_index - 1u] = new_ent_id;
             return wrap_entity(new_ent_id);
-
         }
         if ( last_entity_id_ >= detail::entity_id_index_mask ) {
             throw std::logic_error("ecs_hpp::registry (entity index overlow)");
         }
-        if ( free_entity_ids_.capacity() <= entity_ids_.size() ) {
-            // ensure free entity ids capacity for safe (noexcept) entity destroying
-            free_entity_ids_.reserve(detail::next_capacity_size(
-                free_entity_ids_.capacity(),
-                entity_ids_.size() + 1,
-                free_entity_ids_.max_size()));
+        entity_slots_.push_back(last_entity_id_ + 1);
+        try {
+            entity_ids_.insert(last_entity_id_ + 1);
+        } catch (...) {
+            entity_slots_.pop_back();
+            throw;
         }
-        entity_ids_.insert(last_entity_id_ + 1);
         return wrap_entity(++last_entity_id_);
     }
 
@@ -2617,6 +4853,17 @@ namespace ecs_hpp
         return ent;
     }
 
+    inline entity registry::create_entity(const baked_prototype& proto) {
+        auto ent = create_entity();
+        try {
+            proto.apply_to_entity(ent, true);
+        } catch (...) {
+            destroy_entity(ent);
+            throw;
+        }
+        return ent;
+    }
+
     inline entity registry::create_entity(const const_uentity& proto) {
         assert(valid_entity(proto));
         entity ent = create_entity();
@@ -2624,6 +4871,11 @@ namespace ecs_hpp
             for ( const auto family : storages_ ) {
                 storages_.get(family)->clone(proto, ent.id());
             }
+            copy_signature_(proto, ent.id());
+            for ( const auto family : groups_ ) {
+                groups_.get(family)->on_assign(ent.id());
+            }
+            signal_clone_(ent.id());
         } catch (...) {
             destroy_entity(ent);
             throw;
@@ -2631,49 +4883,280 @@ namespace ecs_hpp
         return ent;
     }
 
-    inline void registry::destroy_entity(const uentity& ent) noexcept {
+    template < typename Iterator >
+    Iterator registry::create_entities(std::size_t count, Iterator iter) {
         assert(!entity_ids_locker_.is_locked());
-        assert(valid_entity(ent));
-        remove_all_components(ent);
-        if ( entity_ids_.unordered_erase(ent) ) {
-            assert(free_entity_ids_.size() < free_entity_ids_.capacity());
-            free_entity_ids_.push_back(ent);
+        // every slot is either live or linked into the free list,
+        // so only the creations over the free count add new slots
+        const std::size_t free_count = entity_slots_.size() - entity_ids_.size();
+        if ( count > free_count ) {
+            entity_slots_.reserve(entity_slots_.size() + (count - free_count));
+        }
+        entity_ids_.reserve(entity_ids_.size() + count);
+        for ( std::size_t i = 0; i < count; ++i ) {
+            *iter++ = create_entity();
         }
+        return iter;
     }
 
-    inline bool registry::valid_entity(const const_uentity& ent) const noexcept {
-        assert(ent.check_owner(this));
-        return entity_ids_.has(ent);
+    template < typename Iterator >
+    Iterator registry::create_entities(std::size_t count, const prototype& proto, Iterator iter) {
+        std::vector<entity> new_entities;
+        new_entities.reserve(count);
+        create_entities(count, std::back_inserter(new_entities));
+        try {
+            proto.apply_to_entities(new_entities.begin(), new_entities.end(), true);
+        } catch (...) {
+            destroy_entities(new_entities.begin(), new_entities.end());
+            throw;
+        }
+        return std::copy(new_entities.begin(), new_entities.end(), iter);
     }
 
-    template < typename T, typename... Args >
-    T& registry::assign_component(const uentity& ent, Args&&... args) {
-        assert(valid_entity(ent));
-        return get_or_create_storage_<T>().assign(
-            ent,
-            std::forward<Args>(args)...);
+    template < typename Iterator >
+    Iterator registry::create_entities(std::size_t count, const baked_prototype& proto, Iterator iter) {
+        std::vector<entity> new_entities;
+        new_entities.reserve(count);
+        create_entities(count, std::back_inserter(new_entities));
+        try {
+            proto.apply_to_entities(new_entities.begin(), new_entities.end(), true);
+        } catch (...) {
+            destroy_entities(new_entities.begin(), new_entities.end());
+            throw;
+        }
+        return std::copy(new_entities.begin(), new_entities.end(), iter);
     }
 
-    template < typename T, typename... Args >
-    T& registry::ensure_component(const uentity& ent, Args&&... args) {
-        assert(valid_entity(ent));
-        return get_or_create_storage_<T>().ensure(
-            ent,
-            std::forward<Args>(args)...);
-    }
+    template < typename Iterator >
+    Iterator registry::clone_n(const const_uentity& proto, std::size_t count, Iterator iter) {
+        assert(valid_entity(proto));
+        std::vector<entity> new_entities;
+        new_entities.reserve(count);
+        create_entities(count, std::back_inserter(new_entities));
+        try {
+            for ( const auto family : storages_ ) {
+                const storage_uptr& storage = storages_.get(family);
+                for ( const entity& ent : new_entities ) {
+                    storage->clone(proto, ent.id());
+                }
+            }
+            for ( const entity& ent : new_entities ) {
+                copy_signature_(proto, ent.id());
+            }
+            for ( const auto family : groups_ ) {
+                const group_uptr& group = groups_.get(family);
+                for ( const entity& ent : new_entities ) {
+                    group->on_assign(ent.id());
+                }
+            }
+            for ( const entity& ent : new_entities ) {
+                signal_clone_(ent.id());
+            }
+        } catch (...) {
+            destroy_entities(new_entities.begin(), new_entities.end());
+            throw;
+        }
+        return std::copy(new_entities.begin(), new_entities.end(), iter);
+    }
+
+    inline entity registry::move_entity(const uentity& ent, registry& dst) {
+        assert(this != &dst);
+        assert(valid_entity(ent));
+        entity new_ent = dst.create_entity();
+        try {
+            dst.ensure_signature_(new_ent.id());
+            for ( const auto family : storages_ ) {
+                const storage_uptr& src_storage = storages_.get(family);
+                if ( !src_storage->has(ent) ) {
+                    continue;
+                }
+                storage_uptr* dst_storage = dst.storages_.find(family);
+                if ( !dst_storage ) {
+                    dst_storage = dst.storages_.insert(
+                        family,
+                        src_storage->clone_empty(dst)).first;
+                    ++dst.storages_epoch_;
+                }
+                src_storage->move_to(ent, **dst_storage, new_ent.id());
+                dst.set_signature_bit_(new_ent.id(), family);
+                dst.notify_groups_on_assign_(family, new_ent.id());
+                if ( dst.construct_signals_.has(family) ) {
+                    dst.signal_construct_(family, new_ent.id());
+                }
+            }
+        } catch (...) {
+            dst.destroy_entity(uentity{dst, new_ent.id()});
+            throw;
+        }
+        // the moved-from husks are removed with the usual destroy
+        // path, so source groups and destroy signals stay consistent
+        destroy_entity(ent);
+        return new_ent;
+    }
+
+    inline void registry::destroy_entity(const uentity& ent) noexcept {
+        assert(!entity_ids_locker_.is_locked());
+        assert(valid_entity(ent));
+        remove_all_components(ent);
+        if ( entity_ids_.unordered_erase(ent) ) {
+            const entity_id index = detail::entity_id_index(ent);
+            assert(index > 0u && index <= entity_slots_.size());
+            entity_slots_[index - 1u] = detail::entity_id_join(
+                free_entity_head_,
+                detail::entity_id_version(detail::upgrade_entity_id(ent)));
+            free_entity_head_ = index;
+        }
+    }
+
+    template < typename Iterator >
+    void registry::destroy_entities(Iterator first, Iterator last) noexcept {
+        for ( ; first != last; ++first ) {
+            destroy_entity(uentity{*this, first->id()});
+        }
+    }
+
+    inline bool registry::valid_entity(const const_uentity& ent) const noexcept {
+        assert(ent.check_owner(this));
+        return entity_ids_.has(ent);
+    }
+
+    template < typename T, typename... Args >
+    T& registry::assign_component(const uentity& ent, Args&&... args) {
+        assert(valid_entity(ent));
+        ensure_signature_(ent);
+        const family_id family = detail::type_family<T>::id();
+        detail::component_storage<T>& storage = get_or_create_storage_<T>();
+        const bool constructed = construct_signals_.has(family)
+            && !storage.exists(ent);
+        T& component = storage.assign(
+            ent,
+            std::forward<Args>(args)...);
+        set_signature_bit_(ent, family);
+        notify_groups_on_assign_(family, ent);
+        if ( constructed ) {
+            signal_construct_(family, ent);
+        }
+        return component;
+    }
+
+    template < typename T, typename... Args >
+    T& registry::emplace_component(const uentity& ent, Args&&... args) {
+        assert(valid_entity(ent));
+        ensure_signature_(ent);
+        const family_id family = detail::type_family<T>::id();
+        detail::component_storage<T>& storage = get_or_create_storage_<T>();
+        const bool constructed = construct_signals_.has(family)
+            && !storage.exists(ent);
+        T& component = storage.emplace(
+            ent,
+            std::forward<Args>(args)...);
+        set_signature_bit_(ent, family);
+        notify_groups_on_assign_(family, ent);
+        if ( constructed ) {
+            signal_construct_(family, ent);
+        }
+        return component;
+    }
+
+    template < typename T, typename... Args >
+    T& registry::ensure_component(const uentity& ent, Args&&... args) {
+        assert(valid_entity(ent));
+        ensure_signature_(ent);
+        const family_id family = detail::type_family<T>::id();
+        detail::component_storage<T>& storage = get_or_create_storage_<T>();
+        const bool constructed = construct_signals_.has(family)
+            && !storage.exists(ent);
+        T& component = storage.ensure(
+            ent,
+            std::forward<Args>(args)...);
+        set_signature_bit_(ent, family);
+        notify_groups_on_assign_(family, ent);
+        if ( constructed ) {
+            signal_construct_(family, ent);
+        }
+        return component;
+    }
+
+    template < typename T, typename Iterator, typename ValueIterator, typename >
+    void registry::insert(Iterator ids_first, Iterator ids_last, ValueIterator values_first) {
+        const family_id family = detail::type_family<T>::id();
+        detail::component_storage<T>& storage = get_or_create_storage_<T>();
+        for ( Iterator iter = ids_first; iter != ids_last; ++iter ) {
+            const uentity ent{*this, *iter};
+            assert(valid_entity(ent));
+            assert(!storage.exists(ent));
+            ensure_signature_(ent);
+        }
+        storage.insert_range(ids_first, ids_last, values_first);
+        for ( Iterator iter = ids_first; iter != ids_last; ++iter ) {
+            const uentity ent{*this, *iter};
+            set_signature_bit_(ent, family);
+            notify_groups_on_assign_(family, ent);
+        }
+        if ( construct_signals_.has(family) ) {
+            for ( Iterator iter = ids_first; iter != ids_last; ++iter ) {
+                signal_construct_(family, uentity{*this, *iter});
+            }
+        }
+    }
+
+    template < typename T, typename Iterator >
+    void registry::insert(Iterator ids_first, Iterator ids_last, const T& value) {
+        const family_id family = detail::type_family<T>::id();
+        detail::component_storage<T>& storage = get_or_create_storage_<T>();
+        for ( Iterator iter = ids_first; iter != ids_last; ++iter ) {
+            const uentity ent{*this, *iter};
+            assert(valid_entity(ent));
+            assert(!storage.exists(ent));
+            ensure_signature_(ent);
+        }
+        storage.insert_range(ids_first, ids_last, value);
+        for ( Iterator iter = ids_first; iter != ids_last; ++iter ) {
+            const uentity ent{*this, *iter};
+            set_signature_bit_(ent, family);
+            notify_groups_on_assign_(family, ent);
+        }
+        if ( construct_signals_.has(family) ) {
+            for ( Iterator iter = ids_first; iter != ids_last; ++iter ) {
+                signal_construct_(family, uentity{*this, *iter});
+            }
+        }
+    }
+
+    template < typename T, typename F >
+    T& registry::patch_component(const uentity& ent, F&& f) {
+        assert(valid_entity(ent));
+        T& component = get_component<T>(ent);
+        f(component);
+        if ( detail::component_storage<T>* storage = find_storage_<T>() ) {
+            storage->mark_changed(ent);
+        }
+        return component;
+    }
 
     template < typename T >
     bool registry::remove_component(const uentity& ent) noexcept {
         assert(valid_entity(ent));
         detail::component_storage<T>* storage = find_storage_<T>();
-        return storage
-            ? storage->remove(ent)
-            : false;
+        if ( !storage || !storage->exists(ent) ) {
+            return false;
+        }
+        notify_groups_on_remove_(detail::type_family<T>::id(), ent);
+        clear_signature_bit_(ent, detail::type_family<T>::id());
+        const bool removed = storage->remove(ent);
+        if ( removed ) {
+            signal_destroy_(detail::type_family<T>::id(), ent);
+        }
+        return removed;
     }
 
     template < typename T >
     bool registry::exists_component(const const_uentity& ent) const noexcept {
         assert(valid_entity(ent));
+        const family_id family = detail::type_family<T>::id();
+        if ( family - 1u < signature_bits_ ) {
+            return test_signature_bit_(ent, family);
+        }
         const detail::component_storage<T>* storage = find_storage_<T>();
         return storage
             ? storage->exists(ent)
@@ -2682,10 +5165,13 @@ namespace ecs_hpp
 
     inline std::size_t registry::remove_all_components(const uentity& ent) noexcept {
         assert(valid_entity(ent));
+        notify_groups_on_remove_all_(ent);
+        clear_signature_(ent);
         std::size_t removed_count = 0u;
         for ( const auto family : storages_ ) {
             if ( storages_.get(family)->remove(ent) ) {
                 ++removed_count;
+                signal_destroy_(family, ent);
             }
         }
         return removed_count;
@@ -2694,9 +5180,16 @@ namespace ecs_hpp
     template < typename T >
     std::size_t registry::remove_all_components() noexcept {
         detail::component_storage<T>* storage = find_storage_<T>();
-        return storage
-            ? storage->remove_all()
-            : 0u;
+        if ( !storage ) {
+            return 0u;
+        }
+        const family_id family = detail::type_family<T>::id();
+        notify_groups_on_clear_(family);
+        for ( std::size_t i = 0, e = storage->count(); i < e; ++i ) {
+            clear_signature_bit_(storage->id_at(i), family);
+            signal_destroy_(family, storage->id_at(i));
+        }
+        return storage->remove_all();
     }
 
     template < typename T >
@@ -2736,339 +5229,1505 @@ namespace ecs_hpp
     }
 
     template < typename... Ts >
-    std::tuple<Ts&...> registry::get_components(const uentity& ent) {
-        (void)ent;
-        assert(valid_entity(ent));
-        return std::make_tuple(std::ref(get_component<Ts>(ent))...);
+    std::tuple<Ts&...> registry::get_components(const uentity& ent) {
+        auto components = find_components<Ts...>(ent);
+        if ( detail::tuple_contains(components, nullptr) ) {
+            throw std::logic_error("ecs_hpp::registry (component not found)");
+        }
+        return std::apply([](auto*... cs){
+            return std::tuple<Ts&...>(*cs...);
+        }, components);
+    }
+
+    template < typename... Ts >
+    std::tuple<const Ts&...> registry::get_components(const const_uentity& ent) const {
+        auto components = find_components<Ts...>(ent);
+        if ( detail::tuple_contains(components, nullptr) ) {
+            throw std::logic_error("ecs_hpp::registry (component not found)");
+        }
+        return std::apply([](const auto*... cs){
+            return std::tuple<const Ts&...>(*cs...);
+        }, components);
+    }
+
+    template < typename... Ts >
+    std::tuple<Ts*...> registry::find_components(const uentity& ent) noexcept {
+        (void)ent;
+        assert(valid_entity(ent));
+        return std::make_tuple([this, &ent]() -> Ts* {
+            detail::component_storage<Ts>* storage = find_storage_<Ts>();
+            return storage ? storage->find(ent) : nullptr;
+        }()...);
+    }
+
+    template < typename... Ts >
+    std::tuple<const Ts*...> registry::find_components(const const_uentity& ent) const noexcept {
+        (void)ent;
+        assert(valid_entity(ent));
+        return std::make_tuple([this, &ent]() -> const Ts* {
+            const detail::component_storage<Ts>* storage = find_storage_<Ts>();
+            return storage ? storage->find(ent) : nullptr;
+        }()...);
+    }
+
+    template < typename... Ts >
+    std::tuple<Ts&...> registry::get_or_assign_components(const uentity& ent) {
+        (void)ent;
+        assert(valid_entity(ent));
+        return std::tuple<Ts&...>(ensure_component<Ts>(ent)...);
+    }
+
+    template < typename T >
+    std::size_t registry::component_count() const noexcept {
+        const detail::component_storage<T>* storage = find_storage_<T>();
+        return storage
+            ? storage->count()
+            : 0u;
+    }
+
+    inline std::size_t registry::entity_count() const noexcept {
+        return entity_ids_.size();
+    }
+
+    inline std::size_t registry::entity_component_count(const const_uentity& ent) const noexcept {
+        assert(valid_entity(ent));
+        std::size_t component_count = 0u;
+        for ( const auto family : storages_ ) {
+            if ( storages_.get(family)->has(ent) ) {
+                ++component_count;
+            }
+        }
+        return component_count;
+    }
+
+    inline void registry::reserve_entities(std::size_t count) {
+        entity_slots_.reserve(count);
+        entity_ids_.reserve(count);
+    }
+
+    template < typename T >
+    void registry::reserve(std::size_t count) {
+        get_or_create_storage_<T>().reserve(count);
+    }
+
+    inline std::size_t registry::entity_capacity() const noexcept {
+        return entity_ids_.capacity();
+    }
+
+    template < typename T >
+    std::size_t registry::component_capacity() const noexcept {
+        const detail::component_storage<T>* storage = find_storage_<T>();
+        return storage
+            ? storage->capacity()
+            : 0u;
+    }
+
+    template < typename... Ts, typename Writer >
+    void registry::snapshot(Writer&& writer) const {
+        static_assert(
+            (... && std::is_trivially_copyable_v<Ts>),
+            "only trivially copyable components can be snapshotted");
+        detail::snapshot_write_value(writer, std::uint64_t(last_entity_id_));
+        detail::snapshot_write_value(writer, std::uint64_t(free_entity_head_));
+        detail::snapshot_write_array(writer, entity_slots_.data(), entity_slots_.size());
+        detail::snapshot_write_array(writer, entity_ids_.data(), entity_ids_.size());
+        (... , snapshot_storage_<Ts>(writer));
+    }
+
+    template < typename... Ts, typename Reader >
+    void registry::restore(Reader&& reader) {
+        static_assert(
+            (... && std::is_trivially_copyable_v<Ts>),
+            "only trivially copyable components can be restored");
+        assert(!entity_ids_locker_.is_locked());
+        while ( !entity_ids_.empty() ) {
+            destroy_entity(uentity{*this, entity_ids_.at(entity_ids_.size() - 1u)});
+        }
+        std::uint64_t last_id = 0u;
+        detail::snapshot_read_value(reader, last_id);
+        last_entity_id_ = static_cast<entity_id>(last_id);
+        std::uint64_t free_head = 0u;
+        detail::snapshot_read_value(reader, free_head);
+        free_entity_head_ = static_cast<entity_id>(free_head);
+        detail::snapshot_read_vector(reader, entity_slots_);
+        std::vector<entity_id> ids;
+        detail::snapshot_read_vector(reader, ids);
+        entity_ids_.reserve(ids.size());
+        for ( const entity_id id : ids ) {
+            entity_ids_.insert(id);
+        }
+        (... , restore_storage_<Ts>(reader));
+    }
+
+    template < typename T, typename Writer >
+    void registry::snapshot_storage_(Writer& writer) const {
+        const detail::component_storage<T>* storage = find_storage_<T>();
+        const std::size_t count = storage ? storage->count() : 0u;
+        detail::snapshot_write_array(
+            writer,
+            storage ? storage->ids_data() : nullptr,
+            count);
+        if constexpr ( !std::is_empty_v<T> ) {
+            detail::snapshot_write_array(
+                writer,
+                storage ? storage->values_data() : nullptr,
+                count);
+        }
+    }
+
+    template < typename T, typename Reader >
+    void registry::restore_storage_(Reader& reader) {
+        std::vector<entity_id> ids;
+        detail::snapshot_read_vector(reader, ids);
+        detail::component_storage<T>& storage = get_or_create_storage_<T>();
+        storage.remove_all();
+        storage.reserve(ids.size());
+        if constexpr ( std::is_empty_v<T> ) {
+            for ( const entity_id id : ids ) {
+                assign_component<T>(uentity{*this, id});
+            }
+        } else {
+            std::vector<T> values;
+            detail::snapshot_read_vector(reader, values);
+            assert(values.size() == ids.size());
+            for ( std::size_t i = 0, e = ids.size(); i < e; ++i ) {
+                assign_component<T>(uentity{*this, ids[i]}, values[i]);
+            }
+        }
+    }
+
+    template < typename F, typename... Opts >
+    void registry::for_each_entity(F&& f, Opts&&... opts) {
+        detail::incremental_lock_guard lock(entity_ids_locker_);
+        for ( const auto e : entity_ids_ ) {
+            if ( uentity ent{*this, e}; (... && opts(ent)) ) {
+                f(ent);
+            }
+        }
+    }
+
+    template < typename F, typename... Opts >
+    void registry::for_each_entity(F&& f, Opts&&... opts) const {
+        detail::incremental_lock_guard lock(entity_ids_locker_);
+        for ( const auto e : entity_ids_ ) {
+            if ( const_uentity ent{*this, e}; (... && opts(ent)) ) {
+                f(ent);
+            }
+        }
+    }
+
+    template < typename T, typename F, typename... Opts >
+    void registry::for_each_component(F&& f, Opts&&... opts) {
+        if ( detail::component_storage<T>* storage = find_storage_<T>() ) {
+            storage->for_each_component([this, &f, &opts...](const entity_id e, T& t){
+                if ( uentity ent{*this, e}; (... && opts(ent)) ) {
+                    f(ent, t);
+                }
+            });
+        }
+    }
+
+    template < typename T >
+    void registry::track_changes(bool enabled) {
+        get_or_create_storage_<T>().set_tracking(enabled);
+    }
+
+    template < typename T, typename F, typename... Opts >
+    void registry::for_changed_components(F&& f, Opts&&... opts) {
+        if ( detail::component_storage<T>* storage = find_storage_<T>() ) {
+            storage->for_each_changed([this, &f, &opts...](const entity_id e, T& t){
+                if ( uentity ent{*this, e}; (... && opts(ent)) ) {
+                    f(ent, t);
+                }
+            });
+            storage->clear_changed();
+        }
+    }
+
+    template < typename T, typename F >
+    void registry::sort(F&& compare) {
+        detail::component_storage<T>* storage = find_storage_<T>();
+        if ( !storage ) {
+            return;
+        }
+        throw_if_group_owned_(detail::type_family<T>::id());
+        storage->sort(std::forward<F>(compare));
+    }
+
+    template < typename T, typename U >
+    void registry::sort_as() {
+        detail::component_storage<T>* storage = find_storage_<T>();
+        const detail::component_storage<U>* other = find_storage_<U>();
+        if ( !storage || !other ) {
+            return;
+        }
+        throw_if_group_owned_(detail::type_family<T>::id());
+        std::size_t pos = 0u;
+        const std::size_t count = storage->count();
+        for ( std::size_t i = 0, e = other->count(); i < e && pos < count; ++i ) {
+            const auto dense_index_p = storage->find_dense_index(other->id_at(i));
+            if ( dense_index_p.second ) {
+                storage->swap_dense(dense_index_p.first, pos);
+                ++pos;
+            }
+        }
+    }
+
+    template < typename T, typename F, typename... Opts >
+    void registry::for_each_component(F&& f, Opts&&... opts) const {
+        if ( const detail::component_storage<T>* storage = find_storage_<T>() ) {
+            storage->for_each_component([this, &f, &opts...](const entity_id e, const T& t){
+                if ( const_uentity ent{*this, e}; (... && opts(ent)) ) {
+                    f(ent, t);
+                }
+            });
+        }
+    }
+
+    template < typename... Ts, typename F, typename... Opts >
+    void registry::for_joined_components(F&& f, Opts&&... opts) {
+        if constexpr ( sizeof...(Ts) > 0u ) {
+            const auto ss = std::make_tuple(find_storage_<Ts>()...);
+            if ( !detail::tuple_contains(ss, nullptr) ) {
+                for_joined_components_impl_(
+                    ss,
+                    std::forward<F>(f),
+                    std::forward<Opts>(opts)...);
+            }
+        } else {
+            for_each_entity(std::forward<F>(f), std::forward<Opts>(opts)...);
+        }
+    }
+
+    template < typename... Ts, typename F, typename... Opts >
+    void registry::for_joined_components(F&& f, Opts&&... opts) const {
+        if constexpr ( sizeof...(Ts) > 0u ) {
+            const auto ss = std::make_tuple(find_storage_<Ts>()...);
+            if ( !detail::tuple_contains(ss, nullptr) ) {
+                for_joined_components_impl_(
+                    ss,
+                    std::forward<F>(f),
+                    std::forward<Opts>(opts)...);
+            }
+        } else {
+            for_each_entity(std::forward<F>(f), std::forward<Opts>(opts)...);
+        }
+    }
+
+    template < typename... Ts, typename Executor, typename F, typename... Opts >
+    void registry::for_joined_components_par(Executor& executor, F&& f, Opts&&... opts) {
+        static_assert(
+            sizeof...(Ts) > 0u,
+            "ecs_hpp (at least one component type is required for a parallel join)");
+        const auto ss = std::make_tuple(find_storage_<Ts>()...);
+        if ( detail::tuple_contains(ss, nullptr) ) {
+            return;
+        }
+        const std::size_t lead = std::apply([](auto*... storages){
+            const std::array<std::size_t, sizeof...(Ts)> counts{{storages->count()...}};
+            return static_cast<std::size_t>(std::distance(
+                counts.begin(),
+                std::min_element(counts.begin(), counts.end())));
+        }, ss);
+        for_joined_components_par_lead_impl_(
+            std::make_index_sequence<sizeof...(Ts)>(),
+            lead,
+            executor,
+            ss,
+            std::forward<F>(f),
+            std::forward<Opts>(opts)...);
+    }
+
+    template < typename... Ts >
+    view<Ts...> registry::view() noexcept {
+        return ecs_hpp::view<Ts...>(*this);
+    }
+
+    template < typename T >
+    raw_view<T> registry::raw_view() noexcept {
+        if ( detail::component_storage<T>* storage = find_storage_<T>() ) {
+            return ecs_hpp::raw_view<T>(
+                storage->ids_data(),
+                storage->values_data(),
+                storage->count());
+        }
+        return ecs_hpp::raw_view<T>();
+    }
+
+    template < typename T >
+    const_raw_view<T> registry::raw_view() const noexcept {
+        if ( const detail::component_storage<T>* storage = find_storage_<T>() ) {
+            return ecs_hpp::const_raw_view<T>(
+                storage->ids_data(),
+                storage->values_data(),
+                storage->count());
+        }
+        return ecs_hpp::const_raw_view<T>();
+    }
+
+    template < typename... Ts >
+    group<Ts...>& registry::group() {
+        const auto group_family = detail::type_family<ecs_hpp::group<Ts...>>::id();
+        if ( group_uptr* g = groups_.find(group_family) ) {
+            return static_cast<ecs_hpp::group<Ts...>&>(**g);
+        }
+        for ( const auto family : groups_ ) {
+            const detail::group_base& g = *groups_.get(family);
+            if ( (... || g.owns(detail::type_family<Ts>::id())) ) {
+                throw std::logic_error("ecs_hpp::registry (component storage is already owned by another group)");
+            }
+        }
+        auto new_group = std::make_unique<ecs_hpp::group<Ts...>>(*this);
+        ecs_hpp::group<Ts...>& g = *new_group;
+        groups_.insert(group_family, std::move(new_group));
+        return g;
+    }
+
+    template < typename Tag, typename... Args >
+    feature& registry::assign_feature(Args&&... args) {
+        const auto feature_id = detail::type_family<Tag>::id();
+        if ( feature* f = features_.find(feature_id) ) {
+            return *f = feature{std::forward<Args>(args)...};
+        }
+        assert(!features_locker_.is_locked());
+        return *features_.insert(feature_id, feature{std::forward<Args>(args)...}).first;
+    }
+
+    template < typename Tag, typename... Args >
+    feature& registry::ensure_feature(Args&&... args) {
+        const auto feature_id = detail::type_family<Tag>::id();
+        if ( feature* f = features_.find(feature_id) ) {
+            return *f;
+        }
+        assert(!features_locker_.is_locked());
+        return *features_.insert(feature_id, feature{std::forward<Args>(args)...}).first;
+    }
+
+    template < typename Tag >
+    bool registry::has_feature() const noexcept {
+        const auto feature_id = detail::type_family<Tag>::id();
+        return features_.has(feature_id);
+    }
+
+    template < typename Tag >
+    feature& registry::get_feature() {
+        const auto feature_id = detail::type_family<Tag>::id();
+        if ( feature* f = features_.find(feature_id) ) {
+            return *f;
+        }
+        throw std::logic_error("ecs_hpp::registry (feature not found)");
+    }
+
+    template < typename Tag >
+    const feature& registry::get_feature() const {
+        const auto feature_id = detail::type_family<Tag>::id();
+        if ( const feature* f = features_.find(feature_id) ) {
+            return *f;
+        }
+        throw std::logic_error("ecs_hpp::registry (feature not found)");
+    }
+
+    inline registry& registry::flush(command_buffer& commands) {
+        try {
+            commands.apply_(*this);
+        } catch (...) {
+            commands.clear();
+            throw;
+        }
+        commands.clear();
+        return *this;
+    }
+
+    template < typename Event >
+    registry& registry::process_event(const Event& event) {
+        flush_signals();
+        detail::incremental_lock_guard lock(features_locker_);
+        for ( const auto family : features_ ) {
+            if ( feature& f = features_.get(family); f.is_enabled() ) {
+                f.process_event(*this, event);
+            }
+        }
+        return *this;
+    }
+
+    template < typename Executor, typename Event >
+    registry& registry::process_event_par(Executor& executor, const Event& event) {
+        flush_signals();
+        detail::incremental_lock_guard lock(features_locker_);
+        for ( const auto family : features_ ) {
+            if ( feature& f = features_.get(family); f.is_enabled() ) {
+                f.process_event_par(*this, executor, event);
+            }
+        }
+        return *this;
+    }
+
+    template < typename Iterator >
+    registry& registry::process_events(Iterator first, Iterator last) {
+        flush_signals();
+        detail::incremental_lock_guard lock(features_locker_);
+        for ( const auto family : features_ ) {
+            if ( feature& f = features_.get(family); f.is_enabled() ) {
+                for ( Iterator iter = first; iter != last; ++iter ) {
+                    f.process_event(*this, *iter);
+                }
+            }
+        }
+        return *this;
+    }
+
+    template < typename Event >
+    registry& registry::process_events(const Event* events, std::size_t event_count) {
+        flush_signals();
+        detail::incremental_lock_guard lock(features_locker_);
+        for ( const auto family : features_ ) {
+            if ( feature& f = features_.get(family); f.is_enabled() ) {
+                f.process_events(*this, events, event_count);
+            }
+        }
+        return *this;
+    }
+
+    template < typename Event >
+    registry& registry::enqueue_event(Event&& event) {
+        using event_t = std::decay_t<Event>;
+        get_or_create_event_queue_<event_t>().push(std::forward<Event>(event));
+        return *this;
+    }
+
+    inline registry& registry::dispatch_events() {
+        bool dispatched = true;
+        while ( dispatched ) {
+            dispatched = false;
+            for ( const auto family : event_queues_ ) {
+                detail::event_queue_base& queue = *event_queues_.get(family);
+                if ( !queue.empty() ) {
+                    queue.dispatch(*this);
+                    dispatched = true;
+                }
+            }
+        }
+        return *this;
+    }
+
+    template < typename T, typename F >
+    registry& registry::on_construct(F&& f) {
+        const family_id family = detail::type_family<T>::id();
+        signal_listeners* listeners = construct_signals_.find(family);
+        if ( !listeners ) {
+            listeners = construct_signals_.insert(family, signal_listeners()).first;
+        }
+        listeners->push_back(
+            [f = std::forward<F>(f)](registry& owner, entity_id id) mutable {
+                // the entity or component may be gone again
+                // when delivery is batched
+                if ( !owner.valid_entity(id) ) {
+                    return;
+                }
+                if ( T* component = owner.find_component<T>(uentity{owner, id}) ) {
+                    f(owner.wrap_entity(id), *component);
+                }
+            });
+        return *this;
+    }
+
+    template < typename T, typename F >
+    registry& registry::on_destroy(F&& f) {
+        const family_id family = detail::type_family<T>::id();
+        signal_listeners* listeners = destroy_signals_.find(family);
+        if ( !listeners ) {
+            listeners = destroy_signals_.insert(family, signal_listeners()).first;
+        }
+        listeners->push_back(
+            [f = std::forward<F>(f)](registry& owner, entity_id id) mutable {
+                f(owner.wrap_entity(id));
+            });
+        return *this;
+    }
+
+    inline registry& registry::batch_signals(bool enabled) {
+        if ( !enabled ) {
+            flush_signals();
+        }
+        batched_signals_ = enabled;
+        return *this;
+    }
+
+    inline registry& registry::flush_signals() {
+        while ( !pending_signals_.empty() ) {
+            std::vector<pending_signal> pending;
+            pending.swap(pending_signals_);
+            for ( const pending_signal& signal : pending ) {
+                const auto& signals = signal.construct
+                    ? construct_signals_
+                    : destroy_signals_;
+                if ( const signal_listeners* listeners = signals.find(signal.family) ) {
+                    for ( const signal_listener& listener : *listeners ) {
+                        listener(*this, signal.id);
+                    }
+                }
+            }
+        }
+        return *this;
+    }
+
+    inline registry::memory_usage_info registry::memory_usage() const noexcept {
+        memory_usage_info info;
+        info.entities += entity_slots_.capacity() * sizeof(entity_slots_[0]);
+        info.entities += entity_ids_.memory_usage();
+        info.entities += signatures_.capacity() * sizeof(signatures_[0]);
+        for ( const auto family : storages_ ) {
+            info.components += storages_.get(family)->memory_usage();
+        }
+        return info;
+    }
+
+    template < typename T >
+    std::size_t registry::component_memory_usage() const noexcept {
+        const detail::component_storage<T>* storage = find_storage_<T>();
+        return storage
+            ? storage->memory_usage()
+            : 0u;
+    }
+
+    inline registry::stats_info registry::stats() const noexcept {
+        stats_info info;
+    #if defined(ECS_HPP_ENABLE_STATS)
+        for ( const auto family : storages_ ) {
+            const auto& storage_stats = storages_.get(family)->stats;
+            info.component_inserts += storage_stats.inserts;
+            info.component_erases += storage_stats.erases;
+            info.component_probe_misses += storage_stats.probe_misses;
+        }
+        info.join_entities_visited = join_entities_visited_;
+        info.join_entities_matched = join_entities_matched_;
+    #endif
+        return info;
+    }
+
+    inline registry& registry::reset_stats() noexcept {
+    #if defined(ECS_HPP_ENABLE_STATS)
+        for ( const auto family : storages_ ) {
+            storages_.get(family)->stats = {};
+        }
+        join_entities_visited_ = 0u;
+        join_entities_matched_ = 0u;
+        for ( const auto family : features_ ) {
+            features_.get(family).reset_stats();
+        }
+    #endif
+        return *this;
+    }
+
+    template < typename T >
+    detail::component_storage<T>* registry::find_storage_() noexcept {
+        const auto family = detail::type_family<T>::id();
+        using raw_storage_ptr = detail::component_storage<T>*;
+        const storage_uptr* storage_uptr_ptr = storages_.find(family);
+        return storage_uptr_ptr && *storage_uptr_ptr
+            ? static_cast<raw_storage_ptr>(storage_uptr_ptr->get())
+            : nullptr;
+    }
+
+    template < typename T >
+    const detail::component_storage<T>* registry::find_storage_() const noexcept {
+        const auto family = detail::type_family<T>::id();
+        using raw_storage_ptr = const detail::component_storage<T>*;
+        const storage_uptr* storage_uptr_ptr = storages_.find(family);
+        return storage_uptr_ptr && *storage_uptr_ptr
+            ? static_cast<raw_storage_ptr>(storage_uptr_ptr->get())
+            : nullptr;
+    }
+
+    template < typename T >
+    detail::component_storage<T>& registry::get_or_create_storage_() {
+        if ( detail::component_storage<T>* storage = find_storage_<T>() ) {
+            return *storage;
+        }
+        const auto family = detail::type_family<T>::id();
+        storages_.insert(
+            family,
+            std::make_unique<detail::component_storage<T>>(*this));
+        ++storages_epoch_;
+        return *static_cast<detail::component_storage<T>*>(
+            storages_.get(family).get());
+    }
+
+    template < typename Event >
+    detail::typed_event_queue<Event>& registry::get_or_create_event_queue_() {
+        using queue_t = detail::typed_event_queue<Event>;
+        const auto family = detail::type_family<Event>::id();
+        if ( event_queue_uptr* queue = event_queues_.find(family) ) {
+            return *static_cast<queue_t*>(queue->get());
+        }
+        return *static_cast<queue_t*>(event_queues_.insert(
+            family,
+            std::make_unique<queue_t>()).first->get());
+    }
+
+    inline void registry::notify_groups_on_assign_(family_id family, entity_id id) noexcept {
+        for ( const auto group_family : groups_ ) {
+            detail::group_base& g = *groups_.get(group_family);
+            if ( g.owns(family) ) {
+                g.on_assign(id);
+            }
+        }
+    }
+
+    inline void registry::notify_groups_on_remove_(family_id family, entity_id id) noexcept {
+        for ( const auto group_family : groups_ ) {
+            detail::group_base& g = *groups_.get(group_family);
+            if ( g.owns(family) ) {
+                g.on_remove(id);
+            }
+        }
+    }
+
+    inline void registry::notify_groups_on_remove_all_(entity_id id) noexcept {
+        for ( const auto group_family : groups_ ) {
+            groups_.get(group_family)->on_remove(id);
+        }
+    }
+
+    inline void registry::notify_groups_on_clear_(family_id family) noexcept {
+        for ( const auto group_family : groups_ ) {
+            detail::group_base& g = *groups_.get(group_family);
+            if ( g.owns(family) ) {
+                g.on_remove_all();
+            }
+        }
+    }
+
+    inline void registry::throw_if_group_owned_(family_id family) const {
+        for ( const auto group_family : groups_ ) {
+            if ( groups_.get(group_family)->owns(family) ) {
+                throw std::logic_error("ecs_hpp::registry (can't reorder a group owned storage)");
+            }
+        }
+    }
+
+    inline void registry::signal_construct_(family_id family, entity_id id) {
+        const signal_listeners* listeners = construct_signals_.find(family);
+        if ( !listeners || listeners->empty() ) {
+            return;
+        }
+        if ( batched_signals_ ) {
+            pending_signals_.push_back({family, id, true});
+            return;
+        }
+        for ( const signal_listener& listener : *listeners ) {
+            listener(*this, id);
+        }
+    }
+
+    inline void registry::signal_destroy_(family_id family, entity_id id) {
+        const signal_listeners* listeners = destroy_signals_.find(family);
+        if ( !listeners || listeners->empty() ) {
+            return;
+        }
+        if ( batched_signals_ ) {
+            pending_signals_.push_back({family, id, false});
+            return;
+        }
+        for ( const signal_listener& listener : *listeners ) {
+            listener(*this, id);
+        }
+    }
+
+    inline void registry::signal_clone_(entity_id id) {
+        if ( construct_signals_.empty() ) {
+            return;
+        }
+        for ( const auto family : storages_ ) {
+            if ( storages_.get(family)->has(id) ) {
+                signal_construct_(family, id);
+            }
+        }
+    }
+
+    inline void registry::ensure_signature_(entity_id id) {
+        const std::size_t index = detail::entity_id_index(id);
+        if ( index >= signatures_.size() ) {
+            signatures_.resize(detail::next_capacity_size(
+                signatures_.size(), index + 1u, signatures_.max_size()));
+        }
+    }
+
+    inline void registry::copy_signature_(entity_id from, entity_id to) {
+        const std::size_t from_index = detail::entity_id_index(from);
+        if ( from_index >= signatures_.size() ) {
+            clear_signature_(to);
+            return;
+        }
+        ensure_signature_(to);
+        signatures_[detail::entity_id_index(to)] = signatures_[from_index];
+    }
+
+    inline void registry::set_signature_bit_(entity_id id, family_id family) noexcept {
+        const std::size_t index = detail::entity_id_index(id);
+        const std::size_t bit = family - 1u;
+        if ( index < signatures_.size() && bit < signature_bits_ ) {
+            signatures_[index][bit / 64u] |= std::uint64_t(1u) << (bit % 64u);
+        }
+    }
+
+    inline void registry::clear_signature_bit_(entity_id id, family_id family) noexcept {
+        const std::size_t index = detail::entity_id_index(id);
+        const std::size_t bit = family - 1u;
+        if ( index < signatures_.size() && bit < signature_bits_ ) {
+            signatures_[index][bit / 64u] &= ~(std::uint64_t(1u) << (bit % 64u));
+        }
+    }
+
+    inline void registry::clear_signature_(entity_id id) noexcept {
+        const std::size_t index = detail::entity_id_index(id);
+        if ( index < signatures_.size() ) {
+            signatures_[index] = signature_t{};
+        }
+    }
+
+    inline bool registry::test_signature_bit_(entity_id id, family_id family) const noexcept {
+        const std::size_t index = detail::entity_id_index(id);
+        const std::size_t bit = family - 1u;
+        return index < signatures_.size()
+            && !!(signatures_[index][bit / 64u] & (std::uint64_t(1u) << (bit % 64u)));
+    }
+
+    template < typename T
+             , typename... Ts
+             , typename F
+             , typename... Opts >
+    void registry::for_joined_components_impl_(
+        const std::tuple<
+            detail::component_storage<T>*,
+            detail::component_storage<Ts>*...>& ss,
+        F&& f,
+        Opts&&... opts)
+    {
+        const std::size_t lead = std::apply([](auto*... storages){
+            const std::array<std::size_t, 1u + sizeof...(Ts)> counts{{storages->count()...}};
+            return static_cast<std::size_t>(std::distance(
+                counts.begin(),
+                std::min_element(counts.begin(), counts.end())));
+        }, ss);
+        for_joined_components_lead_impl_(
+            std::make_index_sequence<1u + sizeof...(Ts)>(),
+            lead,
+            ss,
+            std::forward<F>(f),
+            std::forward<Opts>(opts)...);
+    }
+
+    template < typename T
+             , typename... Ts
+             , typename F
+             , typename... Opts >
+    void registry::for_joined_components_impl_(
+        const std::tuple<
+            const detail::component_storage<T>*,
+            const detail::component_storage<Ts>*...>& ss,
+        F&& f,
+        Opts&&... opts) const
+    {
+        const std::size_t lead = std::apply([](const auto*... storages){
+            const std::array<std::size_t, 1u + sizeof...(Ts)> counts{{storages->count()...}};
+            return static_cast<std::size_t>(std::distance(
+                counts.begin(),
+                std::min_element(counts.begin(), counts.end())));
+        }, ss);
+        for_joined_components_lead_impl_(
+            std::make_index_sequence<1u + sizeof...(Ts)>(),
+            lead,
+            ss,
+            std::forward<F>(f),
+            std::forward<Opts>(opts)...);
+    }
+
+    template < typename... Ts
+             , typename F
+             , typename... Opts
+             , std::size_t... Is >
+    void registry::for_joined_components_lead_impl_(
+        std::index_sequence<Is...>,
+        std::size_t lead,
+        const std::tuple<detail::component_storage<Ts>*...>& ss,
+        F&& f,
+        Opts&&... opts)
+    {
+        ((Is == lead
+            ? for_joined_components_drive_impl_<Is>(ss, f, opts...)
+            : void()), ...);
+    }
+
+    template < typename... Ts
+             , typename F
+             , typename... Opts
+             , std::size_t... Is >
+    void registry::for_joined_components_lead_impl_(
+        std::index_sequence<Is...>,
+        std::size_t lead,
+        const std::tuple<const detail::component_storage<Ts>*...>& ss,
+        F&& f,
+        Opts&&... opts) const
+    {
+        ((Is == lead
+            ? for_joined_components_drive_impl_<Is>(ss, f, opts...)
+            : void()), ...);
+    }
+
+    template < std::size_t I
+             , typename... Ts
+             , typename F
+             , typename... Opts >
+    void registry::for_joined_components_drive_impl_(
+        const std::tuple<detail::component_storage<Ts>*...>& ss,
+        F&& f,
+        Opts&&... opts)
+    {
+        using drive_t = std::tuple_element_t<I, std::tuple<Ts...>>;
+        std::get<I>(ss)->for_each_component(
+        [this, &f, &ss, &opts...](const entity_id e, drive_t&){
+            ECS_HPP_STATS_INC(join_entities_visited_);
+            if ( uentity ent{*this, e}; (... && opts(ent)) ) {
+                std::apply([this, &f, &ent, e](auto*... storages){
+                    (void)this;
+                    if ( const auto cs = std::make_tuple(storages->find(e)...);
+                         !detail::tuple_contains(cs, nullptr) )
+                    {
+                        ECS_HPP_STATS_INC(join_entities_matched_);
+                        std::apply([&f, &ent](auto*... comps){
+                            f(ent, *comps...);
+                        }, cs);
+                    }
+                }, ss);
+            }
+        });
+    }
+
+    template < typename... Ts
+             , typename Executor
+             , typename F
+             , typename... Opts
+             , std::size_t... Is >
+    void registry::for_joined_components_par_lead_impl_(
+        std::index_sequence<Is...>,
+        std::size_t lead,
+        Executor& executor,
+        const std::tuple<detail::component_storage<Ts>*...>& ss,
+        F&& f,
+        Opts&&... opts)
+    {
+        ((Is == lead
+            ? for_joined_components_par_drive_impl_<Is>(executor, ss, f, opts...)
+            : void()), ...);
+    }
+
+    template < std::size_t I
+             , typename... Ts
+             , typename Executor
+             , typename F
+             , typename... Opts >
+    void registry::for_joined_components_par_drive_impl_(
+        Executor& executor,
+        const std::tuple<detail::component_storage<Ts>*...>& ss,
+        F&& f,
+        Opts&&... opts)
+    {
+        auto* drive = std::get<I>(ss);
+        const std::size_t drive_count = drive->count();
+        if ( !drive_count ) {
+            return;
+        }
+
+        const std::size_t task_count = std::max<std::size_t>(1u, std::min(
+            drive_count,
+            static_cast<std::size_t>(std::thread::hardware_concurrency())));
+        const std::size_t chunk_size = (drive_count + task_count - 1u) / task_count;
+
+        std::apply([](auto*... storages){
+            (storages->locker().lock(), ...);
+        }, ss);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t remaining_tasks{0u};
+        std::exception_ptr task_exception;
+
+        const auto process_chunk =
+        [this, &ss, &f, &opts..., drive](std::size_t first, std::size_t last){
+            for ( std::size_t i = first; i < last; ++i ) {
+                const entity_id e = drive->id_at(i);
+                if ( uentity ent{*this, e}; (... && opts(ent)) ) {
+                    std::apply([&f, &ent, e](auto*... storages){
+                        if ( const auto cs = std::make_tuple(storages->find(e)...);
+                             !detail::tuple_contains(cs, nullptr) )
+                        {
+                            std::apply([&f, &ent](auto*... comps){
+                                f(ent, *comps...);
+                            }, cs);
+                        }
+                    }, ss);
+                }
+            }
+        };
+
+        try {
+            for ( std::size_t first = 0u; first < drive_count; first += chunk_size ) {
+                const std::size_t last = std::min(first + chunk_size, drive_count);
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    ++remaining_tasks;
+                }
+                try {
+                    executor(
+                    [&process_chunk, &mutex, &cv, &remaining_tasks, &task_exception, first, last](){
+                        try {
+                            process_chunk(first, last);
+                        } catch (...) {
+                            std::lock_guard<std::mutex> guard(mutex);
+                            if ( !task_exception ) {
+                                task_exception = std::current_exception();
+                            }
+                        }
+                        {
+                            std::lock_guard<std::mutex> guard(mutex);
+                            --remaining_tasks;
+                        }
+                        cv.notify_one();
+                    });
+                } catch (...) {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    --remaining_tasks;
+                    if ( !task_exception ) {
+                        task_exception = std::current_exception();
+                    }
+                    break;
+                }
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&remaining_tasks]{
+                    return !remaining_tasks;
+                });
+            }
+        } catch (...) {
+            std::apply([](auto*... storages){
+                (storages->locker().unlock(), ...);
+            }, ss);
+            throw;
+        }
+
+        std::apply([](auto*... storages){
+            (storages->locker().unlock(), ...);
+        }, ss);
+
+        if ( task_exception ) {
+            std::rethrow_exception(task_exception);
+        }
+    }
+
+    template < std::size_t I
+             , typename... Ts
+             , typename F
+             , typename... Opts >
+    void registry::for_joined_components_drive_impl_(
+        const std::tuple<const detail::component_storage<Ts>*...>& ss,
+        F&& f,
+        Opts&&... opts) const
+    {
+        using drive_t = std::tuple_element_t<I, std::tuple<Ts...>>;
+        std::get<I>(ss)->for_each_component(
+        [this, &f, &ss, &opts...](const entity_id e, const drive_t&){
+            ECS_HPP_STATS_INC(join_entities_visited_);
+            if ( const_uentity ent{*this, e}; (... && opts(ent)) ) {
+                std::apply([this, &f, &ent, e](const auto*... storages){
+                    (void)this;
+                    if ( const auto cs = std::make_tuple(storages->find(e)...);
+                         !detail::tuple_contains(cs, nullptr) )
+                    {
+                        ECS_HPP_STATS_INC(join_entities_matched_);
+                        std::apply([&f, &ent](const auto*... comps){
+                            f(ent, *comps...);
+                        }, cs);
+                    }
+                }, ss);
+            }
+        });
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// detail::event_queue impl
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    namespace detail
+    {
+        template < typename E >
+        void typed_event_queue<E>::dispatch(registry& owner) {
+            // the queue is swapped out first, so events enqueued
+            // by handlers mid-dispatch land in the next pass
+            std::vector<E> events;
+            events.swap(events_);
+            owner.process_events(
+                static_cast<const E*>(events.data()),
+                events.size());
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// compiled_aspect impl
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    template < typename... Ts >
+    compiled_aspect<Ts...>::compiled_aspect(const registry& owner) noexcept
+    : owner_(&owner) {
+        bool mask_usable = true;
+        const auto set_mask_bit = [this, &mask_usable](family_id family) noexcept {
+            const std::size_t bit = family - 1u;
+            if ( bit < registry::signature_bits_ ) {
+                mask_[bit / 64u] |= std::uint64_t(1u) << (bit % 64u);
+            } else {
+                mask_usable = false;
+            }
+        };
+        (... , set_mask_bit(detail::type_family<Ts>::id()));
+        mask_usable_ = mask_usable;
+        refresh_();
+    }
+
+    template < typename... Ts >
+    const registry& compiled_aspect<Ts...>::owner() const noexcept {
+        return *owner_;
+    }
+
+    template < typename... Ts >
+    bool compiled_aspect<Ts...>::match_entity(entity_id id) const noexcept {
+        if ( mask_usable_ ) {
+            // the signature is indexed by the entity index alone,
+            // so stale (recycled) ids have to be rejected up front
+            if ( !(*owner_).entity_ids_.has(id) ) {
+                return false;
+            }
+            const std::size_t index = detail::entity_id_index(id);
+            if ( index >= (*owner_).signatures_.size() ) {
+                return false;
+            }
+            const registry::signature_t& signature = (*owner_).signatures_[index];
+            for ( std::size_t w = 0u; w < registry::signature_words_; ++w ) {
+                if ( (signature[w] & mask_[w]) != mask_[w] ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        if ( !refresh_() ) {
+            return false;
+        }
+        return std::apply([id](const auto*... storages){
+            return (... && storages->exists(id));
+        }, storages_);
+    }
+
+    template < typename... Ts >
+    std::size_t compiled_aspect<Ts...>::count() const noexcept {
+        if ( !refresh_() ) {
+            return 0u;
+        }
+        const std::size_t lead = std::apply([](const auto*... storages){
+            const std::array<std::size_t, sizeof...(Ts)> counts{{storages->count()...}};
+            return static_cast<std::size_t>(std::distance(
+                counts.begin(),
+                std::min_element(counts.begin(), counts.end())));
+        }, storages_);
+        return count_impl_(std::make_index_sequence<sizeof...(Ts)>(), lead);
+    }
+
+    template < typename... Ts >
+    template < std::size_t... Is >
+    std::size_t compiled_aspect<Ts...>::count_impl_(
+        std::index_sequence<Is...>,
+        std::size_t lead) const noexcept
+    {
+        std::size_t result = 0u;
+        const auto matches = [this](entity_id id) noexcept {
+            return std::apply([id](const auto*... storages){
+                return (... && storages->exists(id));
+            }, storages_);
+        };
+        const auto count_with = [&result, &matches](const auto* drive) noexcept {
+            for ( std::size_t i = 0u, e = drive->count(); i < e; ++i ) {
+                if ( matches(drive->id_at(i)) ) {
+                    ++result;
+                }
+            }
+        };
+        ((Is == lead ? count_with(std::get<Is>(storages_)) : void()), ...);
+        return result;
+    }
+
+    template < typename... Ts >
+    bool compiled_aspect<Ts...>::refresh_() const noexcept {
+        if ( epoch_ != (*owner_).storages_epoch_ ) {
+            storages_ = std::make_tuple((*owner_).template find_storage_<Ts>()...);
+            epoch_ = (*owner_).storages_epoch_;
+        }
+        return !detail::tuple_contains(storages_, nullptr);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// view impl
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    template < typename... Ts >
+    view<Ts...>::view(registry& owner) noexcept
+    : owner_(&owner) {}
+
+    template < typename... Ts >
+    registry& view<Ts...>::owner() noexcept {
+        return *owner_;
+    }
+
+    template < typename... Ts >
+    const registry& view<Ts...>::owner() const noexcept {
+        return *owner_;
+    }
+
+    template < typename... Ts >
+    template < typename F, typename... Opts >
+    void view<Ts...>::for_each_entity(F&& f, Opts&&... opts) {
+        for_joined_components([&f](const entity& e, const Ts&...){
+            f(e);
+        }, std::forward<Opts>(opts)...);
+    }
+
+    template < typename... Ts >
+    template < typename F, typename... Opts >
+    void view<Ts...>::for_joined_components(F&& f, Opts&&... opts) {
+        if ( refresh_() ) {
+            (*owner_).for_joined_components_impl_(
+                storages_,
+                std::forward<F>(f),
+                std::forward<Opts>(opts)...);
+        }
+    }
+
+    template < typename... Ts >
+    bool view<Ts...>::refresh_() noexcept {
+        if ( epoch_ != (*owner_).storages_epoch_ ) {
+            storages_ = std::make_tuple((*owner_).template find_storage_<Ts>()...);
+            epoch_ = (*owner_).storages_epoch_;
+        }
+        return !detail::tuple_contains(storages_, nullptr);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//
+// group impl
+//
+// -----------------------------------------------------------------------------
+
+namespace ecs_hpp
+{
+    template < typename... Ts >
+    group<Ts...>::group(registry& owner)
+    : owner_(&owner)
+    , storages_(std::make_tuple(&owner.get_or_create_storage_<Ts>()...)) {
+        std::vector<entity_id> ids;
+        detail::component_storage<std::tuple_element_t<0, std::tuple<Ts...>>>*
+            head = std::get<0>(storages_);
+        ids.reserve(head->count());
+        head->for_each_component([&ids](const entity_id id, const auto&){
+            ids.push_back(id);
+        });
+        for ( const entity_id id : ids ) {
+            on_assign(id);
+        }
     }
 
     template < typename... Ts >
-    std::tuple<const Ts&...> registry::get_components(const const_uentity& ent) const {
-        (void)ent;
-        assert(valid_entity(ent));
-        return std::make_tuple(std::cref(get_component<Ts>(ent))...);
+    registry& group<Ts...>::owner() noexcept {
+        return *owner_;
     }
 
     template < typename... Ts >
-    std::tuple<Ts*...> registry::find_components(const uentity& ent) noexcept {
-        (void)ent;
-        assert(valid_entity(ent));
-        return std::make_tuple(find_component<Ts>(ent)...);
+    const registry& group<Ts...>::owner() const noexcept {
+        return *owner_;
     }
 
     template < typename... Ts >
-    std::tuple<const Ts*...> registry::find_components(const const_uentity& ent) const noexcept {
-        (void)ent;
-        assert(valid_entity(ent));
-        return std::make_tuple(find_component<Ts>(ent)...);
+    bool group<Ts...>::empty() const noexcept {
+        return !size_;
     }
 
-    template < typename T >
-    std::size_t registry::component_count() const noexcept {
-        const detail::component_storage<T>* storage = find_storage_<T>();
-        return storage
-            ? storage->count()
-            : 0u;
+    template < typename... Ts >
+    std::size_t group<Ts...>::size() const noexcept {
+        return size_;
     }
 
-    inline std::size_t registry::entity_count() const noexcept {
-        return entity_ids_.size();
+    template < typename... Ts >
+    template < typename F >
+    void group<Ts...>::for_each_entity(F&& f) {
+        for_joined_components([&f](const entity& e, const Ts&...){
+            f(e);
+        });
     }
 
-    inline std::size_t registry::entity_component_count(const const_uentity& ent) const noexcept {
-        assert(valid_entity(ent));
-        std::size_t component_count = 0u;
-        for ( const auto family : storages_ ) {
-            if ( storages_.get(family)->has(ent) ) {
-                ++component_count;
+    template < typename... Ts >
+    template < typename F >
+    void group<Ts...>::for_joined_components(F&& f) {
+        std::apply([this, &f](auto*... ss){
+            (ss->locker().lock(), ...);
+            try {
+                for ( std::size_t i = 0u; i < size_; ++i ) {
+                    f((*owner_).wrap_entity(std::get<0>(storages_)->id_at(i)),
+                        ss->value_at(i)...);
+                }
+            } catch (...) {
+                (ss->locker().unlock(), ...);
+                throw;
             }
-        }
-        return component_count;
+            (ss->locker().unlock(), ...);
+        }, storages_);
     }
 
-    template < typename F, typename... Opts >
-    void registry::for_each_entity(F&& f, Opts&&... opts) {
-        detail::incremental_lock_guard lock(entity_ids_locker_);
-        for ( const auto e : entity_ids_ ) {
-            if ( uentity ent{*this, e}; (... && opts(ent)) ) {
-                f(ent);
-            }
-        }
+    template < typename... Ts >
+    template < typename T >
+    raw_view<T> group<Ts...>::raw_view() noexcept {
+        static_assert(
+            (... || std::is_same_v<T, Ts>),
+            "ecs_hpp (the component type should be owned by the group)");
+        detail::component_storage<T>* storage =
+            std::get<detail::component_storage<T>*>(storages_);
+        return ecs_hpp::raw_view<T>(
+            storage->ids_data(),
+            storage->values_data(),
+            size_);
     }
 
-    template < typename F, typename... Opts >
-    void registry::for_each_entity(F&& f, Opts&&... opts) const {
-        detail::incremental_lock_guard lock(entity_ids_locker_);
-        for ( const auto e : entity_ids_ ) {
-            if ( const_uentity ent{*this, e}; (... && opts(ent)) ) {
-                f(ent);
-            }
-        }
+    template < typename... Ts >
+    template < typename T >
+    const_raw_view<T> group<Ts...>::raw_view() const noexcept {
+        static_assert(
+            (... || std::is_same_v<T, Ts>),
+            "ecs_hpp (the component type should be owned by the group)");
+        const detail::component_storage<T>* storage =
+            std::get<detail::component_storage<T>*>(storages_);
+        return ecs_hpp::const_raw_view<T>(
+            storage->ids_data(),
+            storage->values_data(),
+            size_);
     }
 
-    template < typename T, typename F, typename... Opts >
-    void registry::for_each_component(F&& f, Opts&&... opts) {
-        if ( detail::component_storage<T>* storage = find_storage_<T>() ) {
-            storage->for_each_component([this, &f, &opts...](const entity_id e, T& t){
-                if ( uentity ent{*this, e}; (... && opts(ent)) ) {
-                    f(ent, t);
-                }
-            });
-        }
+    template < typename... Ts >
+    bool group<Ts...>::owns(family_id family) const noexcept {
+        return (... || (family == detail::type_family<Ts>::id()));
     }
 
-    template < typename T, typename F, typename... Opts >
-    void registry::for_each_component(F&& f, Opts&&... opts) const {
-        if ( const detail::component_storage<T>* storage = find_storage_<T>() ) {
-            storage->for_each_component([this, &f, &opts...](const entity_id e, const T& t){
-                if ( const_uentity ent{*this, e}; (... && opts(ent)) ) {
-                    f(ent, t);
-                }
-            });
+    template < typename... Ts >
+    void group<Ts...>::on_assign(entity_id id) noexcept {
+        if ( is_member_(id) ) {
+            return;
         }
+        const bool matched = std::apply([id](auto*... ss){
+            return (... && ss->has(id));
+        }, storages_);
+        if ( !matched ) {
+            return;
+        }
+        std::apply([this, id](auto*... ss){
+            (ss->swap_dense(ss->find_dense_index(id).first, size_), ...);
+        }, storages_);
+        ++size_;
     }
 
-    template < typename... Ts, typename F, typename... Opts >
-    void registry::for_joined_components(F&& f, Opts&&... opts) {
-        for_joined_components_impl_<Ts...>(
-            std::make_index_sequence<sizeof...(Ts)>(),
-            std::forward<F>(f),
-            std::forward<Opts>(opts)...);
+    template < typename... Ts >
+    void group<Ts...>::on_remove(entity_id id) noexcept {
+        if ( !is_member_(id) ) {
+            return;
+        }
+        --size_;
+        std::apply([this, id](auto*... ss){
+            (ss->swap_dense(ss->find_dense_index(id).first, size_), ...);
+        }, storages_);
     }
 
-    template < typename... Ts, typename F, typename... Opts >
-    void registry::for_joined_components(F&& f, Opts&&... opts) const {
-        for_joined_components_impl_<Ts...>(
-            std::make_index_sequence<sizeof...(Ts)>(),
-            std::forward<F>(f),
-            std::forward<Opts>(opts)...);
+    template < typename... Ts >
+    void group<Ts...>::on_remove_all() noexcept {
+        size_ = 0u;
     }
 
-    template < typename Tag, typename... Args >
-    feature& registry::assign_feature(Args&&... args) {
-        const auto feature_id = detail::type_family<Tag>::id();
-        if ( feature* f = features_.find(feature_id) ) {
-            return *f = feature{std::forward<Args>(args)...};
-        }
-        assert(!features_locker_.is_locked());
-        return *features_.insert(feature_id, feature{std::forward<Args>(args)...}).first;
+    template < typename... Ts >
+    bool group<Ts...>::is_member_(entity_id id) const noexcept {
+        const auto index_p = std::get<0>(storages_)->find_dense_index(id);
+        return index_p.second && index_p.first < size_;
     }
+}
 
-    template < typename Tag, typename... Args >
-    feature& registry::ensure_feature(Args&&... args) {
-        const auto feature_id = detail::type_family<Tag>::id();
-        if ( feature* f = features_.find(feature_id) ) {
-            return *f;
-        }
-        assert(!features_locker_.is_locked());
-        return *features_.insert(feature_id, feature{std::forward<Args>(args)...}).first;
-    }
+// -----------------------------------------------------------------------------
+//
+// command_buffer impl
+//
+// -----------------------------------------------------------------------------
 
-    template < typename Tag >
-    bool registry::has_feature() const noexcept {
-        const auto feature_id = detail::type_family<Tag>::id();
-        return features_.has(feature_id);
+namespace ecs_hpp
+{
+    inline command_buffer::~command_buffer() noexcept {
+        clear();
     }
 
-    template < typename Tag >
-    feature& registry::get_feature() {
-        const auto feature_id = detail::type_family<Tag>::id();
-        if ( feature* f = features_.find(feature_id) ) {
-            return *f;
-        }
-        throw std::logic_error("ecs_hpp::registry (feature not found)");
+    inline command_buffer::command_buffer(command_buffer&& other) noexcept
+    : chunks_(std::move(other.chunks_))
+    , active_chunk_(other.active_chunk_)
+    , head_(other.head_)
+    , tail_(other.tail_)
+    , op_count_(other.op_count_) {
+        other.chunks_.clear();
+        other.active_chunk_ = 0u;
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+        other.op_count_ = 0u;
     }
 
-    template < typename Tag >
-    const feature& registry::get_feature() const {
-        const auto feature_id = detail::type_family<Tag>::id();
-        if ( const feature* f = features_.find(feature_id) ) {
-            return *f;
+    inline command_buffer& command_buffer::operator=(command_buffer&& other) noexcept {
+        if ( this != &other ) {
+            clear();
+            chunks_ = std::move(other.chunks_);
+            active_chunk_ = other.active_chunk_;
+            head_ = other.head_;
+            tail_ = other.tail_;
+            op_count_ = other.op_count_;
+            other.chunks_.clear();
+            other.active_chunk_ = 0u;
+            other.head_ = nullptr;
+            other.tail_ = nullptr;
+            other.op_count_ = 0u;
         }
-        throw std::logic_error("ecs_hpp::registry (feature not found)");
+        return *this;
     }
 
-    template < typename Event >
-    registry& registry::process_event(const Event& event) {
-        detail::incremental_lock_guard lock(features_locker_);
-        for ( const auto family : features_ ) {
-            if ( feature& f = features_.get(family); f.is_enabled() ) {
-                f.process_event(*this, event);
-            }
-        }
+    inline command_buffer& command_buffer::create_entity(prototype proto) {
+        push_op_([proto = std::move(proto)](registry& owner){
+            owner.create_entity(proto);
+        });
         return *this;
     }
 
-    inline registry::memory_usage_info registry::memory_usage() const noexcept {
-        memory_usage_info info;
-        info.entities += free_entity_ids_.capacity() * sizeof(free_entity_ids_[0]);
-        info.entities += entity_ids_.memory_usage();
-        for ( const auto family : storages_ ) {
-            info.components += storages_.get(family)->memory_usage();
-        }
-        return info;
+    inline command_buffer& command_buffer::destroy_entity(const entity& ent) {
+        push_op_([ent = ent](registry&) mutable {
+            ent.destroy();
+        });
+        return *this;
     }
 
-    template < typename T >
-    std::size_t registry::component_memory_usage() const noexcept {
-        const detail::component_storage<T>* storage = find_storage_<T>();
-        return storage
-            ? storage->memory_usage()
-            : 0u;
+    template < typename T, typename... Args >
+    command_buffer& command_buffer::assign_component(const entity& ent, Args&&... args) {
+        push_op_([ent = ent, args = std::make_tuple(std::forward<Args>(args)...)](registry&) mutable {
+            std::apply([&ent](auto&... vs){
+                ent.assign_component<T>(std::move(vs)...);
+            }, args);
+        });
+        return *this;
     }
 
-    template < typename T >
-    detail::component_storage<T>* registry::find_storage_() noexcept {
-        const auto family = detail::type_family<T>::id();
-        using raw_storage_ptr = detail::component_storage<T>*;
-        const storage_uptr* storage_uptr_ptr = storages_.find(family);
-        return storage_uptr_ptr && *storage_uptr_ptr
-            ? static_cast<raw_storage_ptr>(storage_uptr_ptr->get())
-            : nullptr;
+    template < typename T, typename... Args >
+    command_buffer& command_buffer::ensure_component(const entity& ent, Args&&... args) {
+        push_op_([ent = ent, args = std::make_tuple(std::forward<Args>(args)...)](registry&) mutable {
+            std::apply([&ent](auto&... vs){
+                ent.ensure_component<T>(std::move(vs)...);
+            }, args);
+        });
+        return *this;
     }
 
     template < typename T >
-    const detail::component_storage<T>* registry::find_storage_() const noexcept {
-        const auto family = detail::type_family<T>::id();
-        using raw_storage_ptr = const detail::component_storage<T>*;
-        const storage_uptr* storage_uptr_ptr = storages_.find(family);
-        return storage_uptr_ptr && *storage_uptr_ptr
-            ? static_cast<raw_storage_ptr>(storage_uptr_ptr->get())
-            : nullptr;
+    command_buffer& command_buffer::remove_component(const entity& ent) {
+        push_op_([ent = ent](registry&) mutable {
+            ent.remove_component<T>();
+        });
+        return *this;
     }
 
-    template < typename T >
-    detail::component_storage<T>& registry::get_or_create_storage_() {
-        if ( detail::component_storage<T>* storage = find_storage_<T>() ) {
-            return *storage;
-        }
-        const auto family = detail::type_family<T>::id();
-        storages_.insert(
-            family,
-            std::make_unique<detail::component_storage<T>>(*this));
-        return *static_cast<detail::component_storage<T>*>(
-            storages_.get(family).get());
+    inline command_buffer& command_buffer::remove_all_components(const entity& ent) {
+        push_op_([ent = ent](registry&) mutable {
+            ent.remove_all_components();
+        });
+        return *this;
     }
 
-    template < typename F, typename... Opts >
-    void registry::for_joined_components_impl_(
-        std::index_sequence<>,
-        F&& f,
-        Opts&&... opts)
-    {
-        for_each_entity(std::forward<F>(f), std::forward<Opts>(opts)...);
+    inline bool command_buffer::empty() const noexcept {
+        return !op_count_;
     }
 
-    template < typename F, typename... Opts >
-    void registry::for_joined_components_impl_(
-        std::index_sequence<>,
-        F&& f,
-        Opts&&... opts) const
-    {
-        for_each_entity(std::forward<F>(f), std::forward<Opts>(opts)...);
+    inline std::size_t command_buffer::size() const noexcept {
+        return op_count_;
     }
 
-    template < typename T
-             , typename... Ts
-             , typename F
-             , typename... Opts
-             , std::size_t I
-             , std::size_t... Is >
-    void registry::for_joined_components_impl_(
-        std::index_sequence<I, Is...>,
-        F&& f,
-        Opts&&... opts)
-    {
-        const auto ss = std::make_tuple(find_storage_<Ts>()...);
-        if ( detail::tuple_contains(ss, nullptr) ) {
-            return;
+    inline void command_buffer::clear() noexcept {
+        op_base* op = head_;
+        while ( op ) {
+            op_base* next = op->next;
+            op->~op_base();
+            op = next;
         }
-        for_each_component<T>([this, &f, &ss](const uentity& e, T& t) {
-            for_joined_components_impl_<Ts...>(e, f, ss, t);
-        }, std::forward<Opts>(opts)...);
-    }
-
-    template < typename T
-             , typename... Ts
-             , typename F
-             , typename... Opts
-             , std::size_t I
-             , std::size_t... Is >
-    void registry::for_joined_components_impl_(
-        std::index_sequence<I, Is...>,
-        F&& f,
-        Opts&&... opts) const
-    {
-        const auto ss = std::make_tuple(find_storage_<Ts>()...);
-        if ( detail::tuple_contains(ss, nullptr) ) {
-            return;
+        head_ = nullptr;
+        tail_ = nullptr;
+        op_count_ = 0u;
+        for ( chunk& c : chunks_ ) {
+            c.offset = 0u;
         }
-        for_each_component<T>([this, &f, &ss](const const_uentity& e, const T& t) {
-            std::as_const(*this).for_joined_components_impl_<Ts...>(e, f, ss, t);
-        }, std::forward<Opts>(opts)...);
+        active_chunk_ = 0u;
     }
 
-    template < typename T
-             , typename... Ts
-             , typename F
-             , typename Ss
-             , typename... Cs >
-    void registry::for_joined_components_impl_(
-        const uentity& e,
-        const F& f,
-        const Ss& ss,
-        Cs&... cs)
-    {
-        if ( T* c = std::get<0>(ss)->find(e) ) {
-            for_joined_components_impl_<Ts...>(
-                e,
-                f,
-                detail::tuple_tail(ss),
-                cs...,
-                *c);
+    inline void command_buffer::apply_(registry& owner) {
+        for ( op_base* op = head_; op; op = op->next ) {
+            op->apply(owner);
         }
     }
 
-    template < typename T
-             , typename... Ts
-             , typename F
-             , typename Ss
-             , typename... Cs >
-    void registry::for_joined_components_impl_(
-        const const_uentity& e,
-        const F& f,
-        const Ss& ss,
-        const Cs&... cs) const
-    {
-        if ( const T* c = std::get<0>(ss)->find(e) ) {
-            for_joined_components_impl_<Ts...>(
-                e,
-                f,
-                detail::tuple_tail(ss),
-                cs...,
-                *c);
+    template < typename F >
+    void command_buffer::push_op_(F&& f) {
+        using op_t = op_impl<std::decay_t<F>>;
+        void* memory = allocate_(sizeof(op_t), alignof(op_t));
+        op_base* op = new (memory) op_t(std::forward<F>(f));
+        if ( tail_ ) {
+            tail_->next = op;
+        } else {
+            head_ = op;
         }
-    }
-
-    template < typename F, typename... Cs >
-    void registry::for_joined_components_impl_(
-        const uentity& e,
-        const F& f,
-        const std::tuple<>& ss,
-        Cs&... cs)
-    {
-        (void)ss;
-        f(e, cs...);
-    }
-
-    template < typename F, typename... Cs >
-    void registry::for_joined_components_impl_(
-        const const_uentity& e,
-        const F& f,
-        const std::tuple<>& ss,
-        const Cs&... cs) const
-    {
-        (void)ss;
-        f(e, cs...);
+        tail_ = op;
+        ++op_count_;
+    }
+
+    inline void* command_buffer::allocate_(std::size_t size, std::size_t align) {
+        assert(align > 0u && !(align & (align - 1u)));
+        while ( active_chunk_ < chunks_.size() ) {
+            chunk& c = chunks_[active_chunk_];
+            const std::size_t offset = (c.offset + align - 1u) & ~(align - 1u);
+            if ( offset + size <= c.capacity ) {
+                c.offset = offset + size;
+                return c.memory.get() + offset;
+            }
+            ++active_chunk_;
+        }
+        const std::size_t capacity = std::max(size, chunk_capacity);
+        chunks_.push_back(chunk{std::make_unique<std::byte[]>(capacity), capacity, size});
+        active_chunk_ = chunks_.size() - 1u;
+        return chunks_.back().memory.get();
     }
 }
@@ -0,0 +1,78 @@
+#!/bin/bash
+set -e
+
+# Runs the unbench suite and keeps a JSON regression baseline.
+#
+# usage:
+#   run_benchmarks.sh baseline   # run suite and (re)write the baseline file
+#   run_benchmarks.sh compare    # run suite and diff against the baseline
+#
+# extra arguments are forwarded to the benchmark binary,
+# e.g. run_benchmarks.sh compare --benchmark_filter=join
+
+SCRIPT_DIR=`dirname "$BASH_SOURCE"`
+BUILD_DIR=$SCRIPT_DIR/../build/release
+BASELINE=$SCRIPT_DIR/../unbench/baseline.json
+BENCH_BIN=$BUILD_DIR/unbench/ecs.hpp.unbench
+
+MODE=${1:-compare}
+shift || true
+
+if [ ! -x "$BENCH_BIN" ]; then
+    $SCRIPT_DIR/build_release.sh
+fi
+
+case "$MODE" in
+baseline)
+    "$BENCH_BIN" \
+        --benchmark_out="$BASELINE" \
+        --benchmark_out_format=json \
+        "$@"
+    echo "baseline written to $BASELINE"
+    ;;
+compare)
+    if [ ! -f "$BASELINE" ]; then
+        echo "no baseline at $BASELINE, run '$0 baseline' first" >&2
+        exit 1
+    fi
+    CURRENT=`mktemp /tmp/ecs_hpp_bench.XXXXXX.json`
+    trap 'rm -f "$CURRENT"' EXIT
+    "$BENCH_BIN" \
+        --benchmark_out="$CURRENT" \
+        --benchmark_out_format=json \
+        "$@"
+    python3 - "$BASELINE" "$CURRENT" << 'EOF'
+import json, sys
+
+REGRESSION_THRESHOLD = 1.10  # flag runs more than 10% slower
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return {b["name"]: b["real_time"]
+            for b in data.get("benchmarks", [])
+            if b.get("run_type", "iteration") == "iteration"}
+
+base, curr = load(sys.argv[1]), load(sys.argv[2])
+regressions = []
+print(f"{'benchmark':<50} {'baseline':>12} {'current':>12} {'ratio':>7}")
+for name in sorted(base.keys() & curr.keys()):
+    ratio = curr[name] / base[name] if base[name] else float("inf")
+    print(f"{name:<50} {base[name]:>12.1f} {curr[name]:>12.1f} {ratio:>7.2f}")
+    if ratio > REGRESSION_THRESHOLD:
+        regressions.append((name, ratio))
+
+if regressions:
+    print(f"\n{len(regressions)} regression(s) over "
+          f"{(REGRESSION_THRESHOLD - 1) * 100:.0f}%:")
+    for name, ratio in regressions:
+        print(f"  {name}: {ratio:.2f}x")
+    sys.exit(1)
+print("\nno regressions")
+EOF
+    ;;
+*)
+    echo "usage: $0 {baseline|compare} [benchmark args...]" >&2
+    exit 1
+    ;;
+esac
@@ -8,6 +8,58 @@
 
 #include <benchmark/benchmark.h>
 
+#include <vector>
+#include <iterator>
+
+#include <ecs.hpp/ecs.hpp>
+
 namespace ecs_hpp_unbench
 {
+    namespace ecs = ecs_hpp;
+
+    struct position_c {
+        float x{0.f};
+        float y{0.f};
+    };
+
+    struct velocity_c {
+        float x{1.f};
+        float y{1.f};
+    };
+
+    struct acceleration_c {
+        float x{0.5f};
+        float y{0.5f};
+    };
+
+    struct scale_c {
+        float x{1.f};
+        float y{1.f};
+    };
+
+    struct color_c {
+        float r{1.f};
+        float g{1.f};
+        float b{1.f};
+        float a{1.f};
+    };
+
+    inline std::vector<ecs::entity> fill_entities(
+        ecs::registry& w,
+        std::size_t count)
+    {
+        std::vector<ecs::entity> ents;
+        ents.reserve(count);
+        w.create_entities(count, std::back_inserter(ents));
+        return ents;
+    }
+
+    // assigns T to every `step`-th entity:
+    // step 1 is 100% density, step 10 is 10%, step 100 is 1%
+    template < typename T >
+    void assign_every(std::vector<ecs::entity>& ents, std::size_t step) {
+        for ( std::size_t i = 0; i < ents.size(); i += step ) {
+            ents[i].assign_component<T>();
+        }
+    }
 }
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * This file is part of the "https://github.com/blackmatov/ecs.hpp"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018-2019, by Matvey Cherevko (blackmatov@gmail.com)
+ ******************************************************************************/
+
+#include "bench_base.hpp"
+using namespace ecs_hpp_unbench;
+
+#include <ecs.hpp/ecs.hpp>
+namespace ecs = ecs_hpp;
+
+namespace
+{
+    void create_destroy_bench(benchmark::State& state) {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        ecs::registry w;
+        std::vector<ecs::entity> ents;
+        ents.reserve(count);
+        for ( auto _ : state ) {
+            w.create_entities(count, std::back_inserter(ents));
+            w.destroy_entities(ents.begin(), ents.end());
+            ents.clear();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void assign_remove_bench(benchmark::State& state) {
+        ecs::registry w;
+        auto ents = fill_entities(w, static_cast<std::size_t>(state.range(0)));
+        for ( auto _ : state ) {
+            for ( ecs::entity& ent : ents ) {
+                ent.assign_component<position_c>();
+            }
+            for ( ecs::entity& ent : ents ) {
+                ent.remove_component<position_c>();
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void batch_insert_bench(benchmark::State& state) {
+        ecs::registry w;
+        auto ents = fill_entities(w, static_cast<std::size_t>(state.range(0)));
+        std::vector<ecs::entity_id> ids;
+        ids.reserve(ents.size());
+        for ( const ecs::entity& ent : ents ) {
+            ids.push_back(ent.id());
+        }
+        const std::vector<position_c> values(ents.size());
+        for ( auto _ : state ) {
+            w.insert<position_c>(ids.begin(), ids.end(), values.data());
+            for ( ecs::entity& ent : ents ) {
+                ent.remove_component<position_c>();
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void find_component_bench(benchmark::State& state) {
+        ecs::registry w;
+        auto ents = fill_entities(w, static_cast<std::size_t>(state.range(0)));
+        assign_every<position_c>(ents, 2u);
+        for ( auto _ : state ) {
+            for ( ecs::entity& ent : ents ) {
+                benchmark::DoNotOptimize(ent.find_component<position_c>());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK(create_destroy_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(assign_remove_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(batch_insert_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(find_component_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
@@ -0,0 +1,46 @@
+/*******************************************************************************
+ * This file is part of the "https://github.com/blackmatov/ecs.hpp"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018-2019, by Matvey Cherevko (blackmatov@gmail.com)
+ ******************************************************************************/
+
+#include "bench_base.hpp"
+using namespace ecs_hpp_unbench;
+
+#include <ecs.hpp/ecs.hpp>
+namespace ecs = ecs_hpp;
+
+namespace
+{
+    struct update_evt {
+        float dt{0.016f};
+    };
+
+    class movement_system final : public ecs::system<update_evt> {
+    public:
+        void process(ecs::registry& owner, const update_evt& evt) override {
+            owner.for_joined_components<position_c, velocity_c>([&evt](
+                const ecs::entity&, position_c& p, const velocity_c& v)
+            {
+                p.x += v.x * evt.dt;
+                p.y += v.y * evt.dt;
+            });
+        }
+    };
+
+    void process_event_bench(benchmark::State& state) {
+        ecs::registry w;
+        w.assign_feature<struct movement_feature>()
+            .add_system<movement_system>();
+        auto ents = fill_entities(w, static_cast<std::size_t>(state.range(0)));
+        assign_every<position_c>(ents, 1u);
+        assign_every<velocity_c>(ents, 1u);
+        for ( auto _ : state ) {
+            w.process_event(update_evt{});
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK(process_event_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
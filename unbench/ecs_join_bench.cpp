@@ -9,3 +9,97 @@ using namespace ecs_hpp_unbench;
 
 #include <ecs.hpp/ecs.hpp>
 namespace ecs = ecs_hpp;
+
+namespace
+{
+    void for_each_component_bench(benchmark::State& state) {
+        ecs::registry w;
+        auto ents = fill_entities(w, static_cast<std::size_t>(state.range(0)));
+        assign_every<position_c>(ents, 1u);
+        for ( auto _ : state ) {
+            w.for_each_component<position_c>([](
+                const ecs::entity&, position_c& p)
+            {
+                p.x += 1.f;
+                benchmark::DoNotOptimize(p);
+            });
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template < std::size_t Step >
+    void join_2_bench(benchmark::State& state) {
+        ecs::registry w;
+        auto ents = fill_entities(w, static_cast<std::size_t>(state.range(0)));
+        assign_every<position_c>(ents, 1u);
+        assign_every<velocity_c>(ents, Step);
+        for ( auto _ : state ) {
+            w.for_joined_components<position_c, velocity_c>([](
+                const ecs::entity&, position_c& p, const velocity_c& v)
+            {
+                p.x += v.x;
+                p.y += v.y;
+            });
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void join_3_bench(benchmark::State& state) {
+        ecs::registry w;
+        auto ents = fill_entities(w, static_cast<std::size_t>(state.range(0)));
+        assign_every<position_c>(ents, 1u);
+        assign_every<velocity_c>(ents, 1u);
+        assign_every<acceleration_c>(ents, 1u);
+        for ( auto _ : state ) {
+            w.for_joined_components<position_c, velocity_c, acceleration_c>([](
+                const ecs::entity&, position_c& p, velocity_c& v, const acceleration_c& a)
+            {
+                v.x += a.x;
+                v.y += a.y;
+                p.x += v.x;
+                p.y += v.y;
+            });
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void join_5_bench(benchmark::State& state) {
+        ecs::registry w;
+        auto ents = fill_entities(w, static_cast<std::size_t>(state.range(0)));
+        assign_every<position_c>(ents, 1u);
+        assign_every<velocity_c>(ents, 1u);
+        assign_every<acceleration_c>(ents, 1u);
+        assign_every<scale_c>(ents, 1u);
+        assign_every<color_c>(ents, 1u);
+        for ( auto _ : state ) {
+            w.for_joined_components<
+                position_c, velocity_c, acceleration_c, scale_c, color_c>([](
+                const ecs::entity&,
+                position_c& p, const velocity_c& v, const acceleration_c&,
+                const scale_c& s, const color_c&)
+            {
+                p.x += v.x * s.x;
+                p.y += v.y * s.y;
+            });
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK(for_each_component_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
+
+BENCHMARK_TEMPLATE(join_2_bench, 1u)
+    ->Name("join_2_bench/density_100")
+    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(join_2_bench, 10u)
+    ->Name("join_2_bench/density_10")
+    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(join_2_bench, 100u)
+    ->Name("join_2_bench/density_1")
+    ->RangeMultiplier(10)->Range(1000, 1000000);
+
+BENCHMARK(join_3_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(join_5_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ * This file is part of the "https://github.com/blackmatov/ecs.hpp"
+ * For conditions of distribution and use, see copyright notice in LICENSE.md
+ * Copyright (C) 2018-2019, by Matvey Cherevko (blackmatov@gmail.com)
+ ******************************************************************************/
+
+#include "bench_base.hpp"
+using namespace ecs_hpp_unbench;
+
+#include <ecs.hpp/ecs.hpp>
+namespace ecs = ecs_hpp;
+
+namespace
+{
+    void prototype_spawn_bench(benchmark::State& state) {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        const auto proto = ecs::prototype()
+            .component<position_c>()
+            .component<velocity_c>()
+            .component<color_c>();
+        ecs::registry w;
+        std::vector<ecs::entity> ents;
+        ents.reserve(count);
+        for ( auto _ : state ) {
+            w.create_entities(count, proto, std::back_inserter(ents));
+            w.destroy_entities(ents.begin(), ents.end());
+            ents.clear();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void baked_prototype_spawn_bench(benchmark::State& state) {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        const ecs::baked_prototype baked{ecs::prototype()
+            .component<position_c>()
+            .component<velocity_c>()
+            .component<color_c>()};
+        ecs::registry w;
+        std::vector<ecs::entity> ents;
+        ents.reserve(count);
+        for ( auto _ : state ) {
+            w.create_entities(count, baked, std::back_inserter(ents));
+            w.destroy_entities(ents.begin(), ents.end());
+            ents.clear();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK(prototype_spawn_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(baked_prototype_spawn_bench)
+    ->RangeMultiplier(10)->Range(1000, 1000000);
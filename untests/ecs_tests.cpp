@@ -6,6 +6,10 @@
 
 #include <catch2/catch.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstring>
+
 #include <ecs.hpp/ecs.hpp>
 namespace ecs = ecs_hpp;
 
@@ -30,6 +34,13 @@ namespace
     struct movable_c{};
     struct disabled_c{};
 
+    struct stable_c {
+        int i{0};
+
+        stable_c() = default;
+        stable_c(int ni) : i(ni) {}
+    };
+
     static_assert(std::is_empty_v<movable_c>, "!!!");
     static_assert(std::is_empty_v<disabled_c>, "!!!");
 
@@ -55,6 +66,68 @@ namespace
             return static_cast<std::size_t>(v.x);
         }
     };
+
+    template < typename T >
+    struct counting_allocator {
+        using value_type = T;
+
+        std::size_t* allocated{nullptr};
+
+        explicit counting_allocator(std::size_t* a) noexcept
+        : allocated(a) {}
+
+        template < typename U >
+        counting_allocator(const counting_allocator<U>& o) noexcept
+        : allocated(o.allocated) {}
+
+        T* allocate(std::size_t n) {
+            *allocated += n * sizeof(T);
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+            std::allocator<T>().deallocate(p, n);
+        }
+    };
+
+    template < typename T, typename U >
+    bool operator==(
+        const counting_allocator<T>& l,
+        const counting_allocator<U>& r) noexcept
+    {
+        return l.allocated == r.allocated;
+    }
+
+    template < typename T, typename U >
+    bool operator!=(
+        const counting_allocator<T>& l,
+        const counting_allocator<U>& r) noexcept
+    {
+        return !(l == r);
+    }
+
+    struct thread_executor {
+        std::vector<std::thread> threads;
+
+        template < typename F >
+        void operator()(F&& task) {
+            threads.emplace_back(std::forward<F>(task));
+        }
+
+        ~thread_executor() {
+            for ( std::thread& t : threads ) {
+                t.join();
+            }
+        }
+    };
+}
+
+namespace ecs_hpp
+{
+    template <>
+    struct component_storage_policy<stable_c> {
+        using type = stable_storage_policy;
+    };
 }
 
 TEST_CASE("detail") {
@@ -195,6 +268,67 @@ TEST_CASE("detail") {
             REQUIRE(s.unordered_erase(position_c(1,2)));
             REQUIRE(s.get_dense_index(position_c(3,4)) == 0);
         }
+        {
+            sparse_set<unsigned> s;
+
+            REQUIRE(s.insert(1u));
+            REQUIRE(s.insert(1000000u));
+            REQUIRE(s.insert(2000000u));
+
+            REQUIRE(s.has(1u));
+            REQUIRE(s.has(1000000u));
+            REQUIRE(s.has(2000000u));
+            REQUIRE_FALSE(s.has(1000001u));
+            REQUIRE(s.get_dense_index(1000000u) == 1u);
+            REQUIRE(s.get_dense_index(2000000u) == 2u);
+
+            // sparse memory is paged: a few distant indices
+            // must not pin a slot for every index in between
+            REQUIRE(s.memory_usage() < 1000000u * sizeof(std::uint32_t));
+
+            REQUIRE(s.unordered_erase(1000000u));
+            REQUIRE_FALSE(s.has(1000000u));
+            REQUIRE(s.has(2000000u));
+            REQUIRE(s.get_dense_index(2000000u) == 1u);
+
+            sparse_set<unsigned> s2 = s;
+            REQUIRE(s2.has(1u));
+            REQUIRE(s2.has(2000000u));
+            REQUIRE(s2.insert(3000000u));
+            REQUIRE_FALSE(s.has(3000000u));
+
+            s = s2;
+            REQUIRE(s.has(3000000u));
+        }
+        {
+            // both dense and sparse pages come from the custom allocator
+            std::size_t allocated = 0u;
+            {
+                sparse_set<
+                    unsigned,
+                    sparse_indexer<unsigned>,
+                    counting_allocator<unsigned>
+                > s{counting_allocator<unsigned>(&allocated)};
+
+                REQUIRE(s.insert(42u));
+                REQUIRE(s.has(42u));
+                REQUIRE(allocated >= 4096u * sizeof(std::uint32_t));
+            }
+
+            allocated = 0u;
+            {
+                sparse_map<
+                    unsigned,
+                    position_c,
+                    sparse_indexer<unsigned>,
+                    counting_allocator<position_c>
+                > m{counting_allocator<position_c>(&allocated)};
+
+                REQUIRE(m.insert(42u, position_c(1, 2)).second);
+                REQUIRE(m.get(42u) == position_c(1, 2));
+                REQUIRE(allocated >= 4096u * sizeof(std::uint32_t) + sizeof(position_c));
+            }
+        }
     }
     SECTION("sparse_map") {
         using namespace ecs::detail;
@@ -734,6 +868,105 @@ TEST_CASE("registry") {
             REQUIRE(c1 == position_c(1,2));
             REQUIRE(c2 == velocity_c(0,0));
         }
+        {
+            // oversized appliers leave the inline applier buffer
+            // for their own heap nodes, but behave the same
+            struct big_c {
+                std::array<int, 128> values{};
+                int tail{0};
+            };
+
+            ecs::prototype p1;
+            p1.component<big_c>(big_c{{}, 42});
+            p1.component<position_c>(1,2);
+
+            const ecs::prototype p2 = p1;
+
+            big_c c1;
+            REQUIRE(p2.apply_to_component(c1));
+            REQUIRE(c1.tail == 42);
+
+            ecs::registry w;
+            const auto e1 = w.create_entity(p2);
+            REQUIRE(e1.get_component<big_c>().tail == 42);
+            REQUIRE(e1.get_component<position_c>() == position_c(1,2));
+        }
+        {
+            // merging a prototype with itself clones its own appliers
+            ecs::prototype p1;
+            p1.component<position_c>(1,2);
+            p1.merge_with(p1, true);
+
+            position_c c1;
+            REQUIRE(p1.apply_to_component(c1));
+            REQUIRE(c1 == position_c(1,2));
+        }
+    }
+    SECTION("baked_prototypes") {
+        struct payload_c {
+            std::vector<int> values;
+        };
+        {
+            // baking flattens trivially copyable components into the blob
+            const ecs::baked_prototype b{ecs::prototype()
+                .component<position_c>(1, 2)
+                .component<velocity_c>(3, 4)};
+
+            REQUIRE_FALSE(b.empty());
+            REQUIRE(b.has_component<position_c>());
+            REQUIRE(b.has_component<velocity_c>());
+            REQUIRE_FALSE(b.has_component<movable_c>());
+
+            ecs::registry w;
+            const auto e1 = w.create_entity(b);
+            const auto e2 = w.create_entity(b);
+
+            REQUIRE(w.entity_count() == 2u);
+            REQUIRE(e1.get_component<position_c>() == position_c(1,2));
+            REQUIRE(e1.get_component<velocity_c>() == velocity_c(3,4));
+            REQUIRE(e2.get_component<position_c>() == position_c(1,2));
+        }
+        {
+            // direct building, rebaking a component overwrites the blob value
+            ecs::baked_prototype b;
+            REQUIRE(b.empty());
+
+            b.component<position_c>(position_c(1, 2));
+            b.component<position_c>(position_c(11, 22));
+
+            ecs::registry w;
+            const auto e1 = w.create_entity(b);
+            REQUIRE(e1.component_count() == 1u);
+            REQUIRE(e1.get_component<position_c>() == position_c(11,22));
+        }
+        {
+            // non trivially copyable components fall back to appliers
+            const auto b = ecs::baked_prototype()
+                .component<position_c>(position_c(1, 2))
+                .component<payload_c>(payload_c{{1, 2, 3}});
+
+            REQUIRE(b.has_component<payload_c>());
+
+            ecs::registry w;
+            const auto e1 = w.create_entity(b);
+            REQUIRE(e1.get_component<position_c>() == position_c(1,2));
+            REQUIRE(e1.get_component<payload_c>().values == std::vector<int>{1, 2, 3});
+        }
+        {
+            // bulk spawning from a baked prototype
+            const ecs::baked_prototype b{ecs::prototype()
+                .component<position_c>(1, 2)};
+
+            ecs::registry w;
+            std::vector<ecs::entity> ents;
+            w.create_entities(3u, b, std::back_inserter(ents));
+
+            REQUIRE(w.entity_count() == 3u);
+            REQUIRE(w.component_count<position_c>() == 3u);
+            for ( const ecs::entity& e : ents ) {
+                REQUIRE(e.get_component<position_c>() == position_c(1,2));
+            }
+        }
     }
     SECTION("component_assigning") {
         {
@@ -980,6 +1213,25 @@ TEST_CASE("registry") {
             REQUIRE(e1.get_component<position_c>().y == 20);
             REQUIRE(e1.get_component<velocity_c>().y == 40);
         }
+        {
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+
+            // existing components are kept, missing ones are default created
+            auto p = e1.get_or_assign_components<position_c, velocity_c>();
+            REQUIRE(std::get<0>(p) == position_c(1, 2));
+            REQUIRE(std::get<1>(p) == velocity_c(0, 0));
+            REQUIRE(e1.component_count() == 2u);
+
+            std::get<1>(p).x = 30;
+            REQUIRE(e1.get_component<velocity_c>() == velocity_c(30, 0));
+
+            auto p2 = w.get_or_assign_components<position_c, velocity_c>(e1.id());
+            REQUIRE(std::get<0>(p2) == position_c(1, 2));
+            REQUIRE(std::get<1>(p2) == velocity_c(30, 0));
+        }
     }
     SECTION("cloning") {
         {
@@ -1189,138 +1441,1359 @@ TEST_CASE("registry") {
             {
             });
         }
-    }
-    SECTION("aspects") {
         {
-            using empty_aspect = ecs::aspect<>;
-
+            // the smallest storage drives the join,
+            // but the callback keeps the declaration order
             ecs::registry w;
 
-            ecs::entity e1 = w.create_entity();
-            REQUIRE(empty_aspect::match_entity(e1));
-
-            ecs::entity e2 = w.create_entity();
-            e2.assign_component<movable_c>();
-            e2.assign_component<position_c>(1,2);
-            REQUIRE(empty_aspect::match_entity(e2));
-
-            ecs::entity e3 = w.create_entity();
-            e3.assign_component<movable_c>();
-            e3.assign_component<position_c>(1,2);
-            e3.assign_component<velocity_c>(3,4);
-            REQUIRE(empty_aspect::match_entity(e3));
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+            auto e3 = w.create_entity();
 
-            {
-                ecs::entity_id acc{};
-                empty_aspect::for_each_entity(w, [&acc](ecs::entity e){
-                    acc += e.id();
-                }, ecs::exists<movable_c>{});
-                REQUIRE(acc == e2.id() + e3.id());
-            }
+            e1.assign_component<position_c>(1, 0);
+            e2.assign_component<position_c>(2, 0);
+            e3.assign_component<position_c>(3, 0);
+            e2.assign_component<velocity_c>(20, 0);
 
             {
-                ecs::entity_id acc{};
-                empty_aspect::for_joined_components(w, [&acc](ecs::entity e){
-                    acc += e.id();
-                }, ecs::exists<movable_c>{});
-                REQUIRE(acc == e2.id() + e3.id());
+                std::size_t count = 0u;
+                w.for_joined_components<position_c, velocity_c>([&count](
+                    ecs::entity, const position_c& p, const velocity_c& v)
+                {
+                    ++count;
+                    REQUIRE(p.x == 2);
+                    REQUIRE(v.x == 20);
+                });
+                REQUIRE(count == 1u);
             }
 
             {
-                ecs::entity_id acc{};
-                w.for_each_entity([&acc](ecs::entity e){
-                    acc += e.id();
-                }, empty_aspect::to_option());
-                REQUIRE(acc == e1.id() + e2.id() + e3.id());
+                std::size_t count = 0u;
+                w.for_joined_components<velocity_c, position_c>([&count](
+                    ecs::entity, const velocity_c& v, const position_c& p)
+                {
+                    ++count;
+                    REQUIRE(v.x == 20);
+                    REQUIRE(p.x == 2);
+                });
+                REQUIRE(count == 1u);
             }
         }
+    }
+    SECTION("views") {
         {
-            using movable = ecs::aspect<
-                position_c,
-                velocity_c>;
-
             ecs::registry w;
 
-            ecs::entity e = w.create_entity();
-            REQUIRE_FALSE(movable::match_entity(e));
-
-            e.assign_component<position_c>(1,2);
-            REQUIRE_FALSE(movable::match_entity(e));
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+            auto e3 = w.create_entity();
 
-            e.assign_component<velocity_c>(3,4);
-            REQUIRE(movable::match_entity(e));
+            auto v = w.view<position_c, velocity_c>();
 
-            ecs::entity e2 = w.create_entity();
-            e2.assign_component<position_c>(1,2);
+            {
+                // storages don't exist yet
+                std::size_t count = 0u;
+                v.for_joined_components([&count](
+                    ecs::entity, const position_c&, const velocity_c&)
+                {
+                    ++count;
+                });
+                REQUIRE(count == 0u);
+            }
 
-            movable::for_joined_components(w,
-            [](ecs::entity_id, position_c& p, const velocity_c& v){
-                p.x += v.x;
-                p.y += v.y;
-            });
+            e1.assign_component<position_c>(1, 2);
+            e1.assign_component<velocity_c>(3, 4);
+            e2.assign_component<position_c>(5, 6);
+            e2.assign_component<velocity_c>(7, 8);
+            e3.assign_component<position_c>(100, 500);
 
-            movable::for_joined_components(std::as_const(w),
-            [](ecs::entity_id, const position_c& p, const velocity_c& v){
-                const_cast<position_c&>(p).x += v.x;
-                const_cast<position_c&>(p).y += v.y;
-            });
+            {
+                // the view is refreshed after the storage creation
+                ecs::entity_id acc1 = 0;
+                int acc2 = 0;
+                v.for_joined_components([&acc1, &acc2](
+                    ecs::entity e, const position_c& p, const velocity_c& vel)
+                {
+                    acc1 += e.id();
+                    acc2 += p.x + vel.x;
+                });
+                REQUIRE(acc1 == e1.id() + e2.id());
+                REQUIRE(acc2 == 16);
+            }
 
-            w.for_each_entity([](ecs::entity e){
-                auto& p = e.get_component<position_c>();
-                const auto& v = e.get_component<velocity_c>();
-                p.x += v.x;
-                p.y += v.y;
-            }, movable::to_option());
+            {
+                ecs::entity_id acc1 = 0;
+                v.for_each_entity([&acc1](ecs::entity e){
+                    acc1 += e.id();
+                });
+                REQUIRE(acc1 == e1.id() + e2.id());
+            }
 
-            std::as_const(w).for_each_entity([](const ecs::const_entity& e){
-                const auto& p = e.get_component<position_c>();
-                const auto& v = e.get_component<velocity_c>();
-                const_cast<position_c&>(p).x += v.x;
-                const_cast<position_c&>(p).y += v.y;
-            }, movable::to_option());
+            {
+                std::size_t count = 0u;
+                v.for_joined_components([&count](
+                    ecs::entity, const position_c&, const velocity_c&)
+                {
+                    ++count;
+                }, ecs::exists<movable_c>{});
+                REQUIRE(count == 0u);
 
-            REQUIRE(e.get_component<position_c>().x == 1 + 3*4);
-            REQUIRE(e.get_component<position_c>().y == 2 + 4*4);
+                e2.assign_component<movable_c>();
+                v.for_joined_components([&count](
+                    ecs::entity, const position_c&, const velocity_c&)
+                {
+                    ++count;
+                }, ecs::exists<movable_c>{});
+                REQUIRE(count == 1u);
+            }
 
-            REQUIRE(e2.get_component<position_c>().x == 1);
-            REQUIRE(e2.get_component<position_c>().y == 2);
+            REQUIRE(&v.owner() == &w);
         }
     }
-    SECTION("options") {
+    SECTION("parallel_joins") {
         {
             ecs::registry w;
 
-            auto e = w.create_entity();
-
-            REQUIRE((!ecs::exists<position_c>{})(e));
-            REQUIRE((!ecs::exists<velocity_c>{})(e));
+            const std::size_t entity_count = 1000u;
+            for ( std::size_t i = 0u; i < entity_count; ++i ) {
+                auto e = w.create_entity();
+                e.assign_component<position_c>(1, 2);
+                if ( i % 2u ) {
+                    e.assign_component<velocity_c>(3, 4);
+                }
+            }
 
-            REQUIRE((!ecs::exists_any<>{})(e));
-            REQUIRE((!ecs::exists_any<position_c>{})(e));
-            REQUIRE((!ecs::exists_any<velocity_c>{})(e));
-            REQUIRE((!ecs::exists_any<position_c, velocity_c>{})(e));
+            {
+                thread_executor executor;
+                std::atomic<std::size_t> count{0u};
+                std::atomic<int> acc{0};
+                w.for_joined_components_par<position_c, velocity_c>(executor,
+                [&count, &acc](ecs::entity, position_c& p, const velocity_c& v){
+                    ++count;
+                    acc += p.x + v.x;
+                    p.y = 100;
+                });
+                REQUIRE(count == entity_count / 2u);
+                REQUIRE(acc == static_cast<int>(entity_count / 2u) * 4);
+            }
 
-            REQUIRE_FALSE((!ecs::exists_all<>{})(e));
-            REQUIRE((!ecs::exists_all<position_c>{})(e));
-            REQUIRE((!ecs::exists_all<velocity_c>{})(e));
-            REQUIRE((!ecs::exists_all<position_c, velocity_c>{})(e));
+            {
+                // options work on the parallel path too
+                thread_executor executor;
+                std::atomic<std::size_t> count{0u};
+                w.for_joined_components_par<position_c>(executor,
+                [&count](ecs::entity, const position_c&){
+                    ++count;
+                }, ecs::exists<velocity_c>{});
+                REQUIRE(count == entity_count / 2u);
+            }
+        }
+        {
+            // missing storages produce an empty parallel join
+            ecs::registry w;
+            thread_executor executor;
+            w.for_joined_components_par<position_c, velocity_c>(executor,
+            [](ecs::entity, const position_c&, const velocity_c&){
+            });
+        }
+    }
+    SECTION("groups") {
+        {
+            ecs::registry w;
 
-            e.assign_component<position_c>();
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+            auto e3 = w.create_entity();
 
-            REQUIRE_FALSE((!ecs::exists<position_c>{})(e));
-            REQUIRE((!ecs::exists<velocity_c>{})(e));
+            e1.assign_component<position_c>(1, 2);
+            e1.assign_component<velocity_c>(3, 4);
+            e2.assign_component<position_c>(5, 6);
+            e3.assign_component<velocity_c>(7, 8);
 
-            REQUIRE((!ecs::exists_any<>{})(e));
-            REQUIRE_FALSE((!ecs::exists_any<position_c>{})(e));
-            REQUIRE((!ecs::exists_any<velocity_c>{})(e));
-            REQUIRE_FALSE((!ecs::exists_any<position_c, velocity_c>{})(e));
+            // the partition is built from already existing components
+            auto& g = w.group<position_c, velocity_c>();
+            REQUIRE(&w.group<position_c, velocity_c>() == &g);
+            REQUIRE(&g.owner() == &w);
 
-            REQUIRE_FALSE((!ecs::exists_all<>{})(e));
-            REQUIRE_FALSE((!ecs::exists_all<position_c>{})(e));
-            REQUIRE((!ecs::exists_all<velocity_c>{})(e));
-            REQUIRE((!ecs::exists_all<position_c, velocity_c>{})(e));
+            REQUIRE(g.size() == 1u);
+            REQUIRE_FALSE(g.empty());
 
-            e.assign_component<velocity_c>();
+            {
+                ecs::entity_id acc1 = 0;
+                int acc2 = 0;
+                g.for_joined_components([&acc1, &acc2](
+                    ecs::entity e, const position_c& p, const velocity_c& v)
+                {
+                    acc1 += e.id();
+                    acc2 += p.x + v.x;
+                });
+                REQUIRE(acc1 == e1.id());
+                REQUIRE(acc2 == 4);
+            }
+
+            // the partition is maintained on component assigning
+            e2.assign_component<velocity_c>(9, 10);
+            REQUIRE(g.size() == 2u);
+
+            e3.assign_component<position_c>(11, 12);
+            REQUIRE(g.size() == 3u);
+
+            {
+                ecs::entity_id acc1 = 0;
+                g.for_each_entity([&acc1](ecs::entity e){
+                    acc1 += e.id();
+                });
+                REQUIRE(acc1 == e1.id() + e2.id() + e3.id());
+            }
+
+            // ... and on component removing
+            e2.remove_component<velocity_c>();
+            REQUIRE(g.size() == 2u);
+
+            e1.destroy();
+            REQUIRE(g.size() == 1u);
+
+            {
+                ecs::entity_id acc1 = 0;
+                g.for_each_entity([&acc1](ecs::entity e){
+                    acc1 += e.id();
+                });
+                REQUIRE(acc1 == e3.id());
+            }
+
+            w.remove_all_components<position_c>();
+            REQUIRE(g.size() == 0u);
+            REQUIRE(g.empty());
+        }
+        {
+            // grouped components are still available for regular joins
+            ecs::registry w;
+            auto& g = w.group<position_c, velocity_c>();
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+            e1.assign_component<velocity_c>(3, 4);
+
+            REQUIRE(g.size() == 1u);
+
+            std::size_t count = 0u;
+            w.for_joined_components<position_c, velocity_c>([&count](
+                ecs::entity, const position_c&, const velocity_c&)
+            {
+                ++count;
+            });
+            REQUIRE(count == 1u);
+
+            // cloned entities join the partition too
+            auto e2 = e1.clone();
+            REQUIRE(g.size() == 2u);
+            REQUIRE(e2.valid());
+        }
+        {
+            // a component storage can be owned by one group only
+            ecs::registry w;
+            w.group<position_c, velocity_c>();
+            REQUIRE_THROWS_AS(
+                (w.group<position_c, movable_c>()),
+                std::logic_error);
+        }
+        {
+            // the group prefix is exposed as lockstep raw views:
+            // index i refers to the same entity in every owned storage
+            ecs::registry w;
+            auto& g = w.group<position_c, velocity_c>();
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+            e1.assign_component<velocity_c>(3, 4);
+
+            auto e2 = w.create_entity();
+            e2.assign_component<position_c>(5, 6);
+
+            auto e3 = w.create_entity();
+            e3.assign_component<position_c>(7, 8);
+            e3.assign_component<velocity_c>(9, 10);
+
+            const auto pv = g.raw_view<position_c>();
+            const auto vv = std::as_const(g).raw_view<velocity_c>();
+
+            REQUIRE(pv.size() == g.size());
+            REQUIRE(vv.size() == g.size());
+
+            int acc = 0;
+            for ( std::size_t i = 0; i < pv.size(); ++i ) {
+                REQUIRE(pv.ids()[i] == vv.ids()[i]);
+                acc += pv.components()[i].x + vv.components()[i].x;
+            }
+            REQUIRE(acc == 1 + 3 + 7 + 9);
+
+            // the views alias the dense storages, writes are visible
+            for ( std::size_t i = 0; i < pv.size(); ++i ) {
+                pv.components()[i].x *= 10;
+            }
+            REQUIRE(e1.get_component<position_c>() == position_c(10, 2));
+            REQUIRE(e3.get_component<position_c>() == position_c(70, 8));
+            REQUIRE(e2.get_component<position_c>() == position_c(5, 6));
+        }
+    }
+    SECTION("command_buffers") {
+        {
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+
+            e1.assign_component<position_c>(1, 2);
+            e2.assign_component<position_c>(3, 4);
+
+            // structural changes are recorded during iteration
+            // and applied on flush
+            ecs::command_buffer commands;
+            w.for_each_component<position_c>([&commands](
+                ecs::entity e, const position_c& p)
+            {
+                commands.assign_component<velocity_c>(e, p.x * 10, p.y * 10);
+            });
+
+            REQUIRE(commands.size() == 2u);
+            REQUIRE_FALSE(commands.empty());
+            REQUIRE(w.component_count<velocity_c>() == 0u);
+
+            w.flush(commands);
+
+            REQUIRE(commands.empty());
+            REQUIRE(w.component_count<velocity_c>() == 2u);
+            REQUIRE(e1.get_component<velocity_c>() == velocity_c(10, 20));
+            REQUIRE(e2.get_component<velocity_c>() == velocity_c(30, 40));
+
+            // the buffer is reusable after a flush
+            commands.remove_component<velocity_c>(e1);
+            commands.destroy_entity(e2);
+            w.flush(commands);
+
+            REQUIRE_FALSE(e1.exists_component<velocity_c>());
+            REQUIRE_FALSE(e2.valid());
+            REQUIRE(w.entity_count() == 1u);
+        }
+        {
+            ecs::registry w;
+
+            ecs::command_buffer commands;
+            commands.create_entity(ecs::prototype()
+                .component<position_c>(1, 2)
+                .component<velocity_c>(3, 4));
+            commands.create_entity(ecs::prototype()
+                .component<position_c>(5, 6));
+
+            w.flush(commands);
+
+            REQUIRE(w.entity_count() == 2u);
+            REQUIRE(w.component_count<position_c>() == 2u);
+            REQUIRE(w.component_count<velocity_c>() == 1u);
+        }
+        {
+            // cleared buffers apply nothing
+            ecs::registry w;
+            auto e1 = w.create_entity();
+
+            ecs::command_buffer commands;
+            commands.destroy_entity(e1);
+            commands.clear();
+            w.flush(commands);
+
+            REQUIRE(e1.valid());
+        }
+    }
+    SECTION("bulk_operations") {
+        {
+            ecs::registry w;
+
+            std::vector<ecs::entity> entities;
+            w.create_entities(100u, std::back_inserter(entities));
+
+            REQUIRE(entities.size() == 100u);
+            REQUIRE(w.entity_count() == 100u);
+            for ( const ecs::entity& e : entities ) {
+                REQUIRE(e.valid());
+            }
+
+            w.destroy_entities(entities.begin(), entities.end());
+            REQUIRE(w.entity_count() == 0u);
+            for ( const ecs::entity& e : entities ) {
+                REQUIRE_FALSE(e.valid());
+            }
+
+            // destroyed indices are recycled by the next bulk burst
+            entities.clear();
+            w.create_entities(100u, std::back_inserter(entities));
+            REQUIRE(w.entity_count() == 100u);
+        }
+        {
+            ecs::registry w;
+
+            const auto proto = ecs::prototype()
+                .component<position_c>(1, 2)
+                .component<velocity_c>(3, 4);
+
+            std::vector<ecs::entity> entities;
+            w.create_entities(50u, proto, std::back_inserter(entities));
+
+            REQUIRE(entities.size() == 50u);
+            REQUIRE(w.component_count<position_c>() == 50u);
+            REQUIRE(w.component_count<velocity_c>() == 50u);
+            for ( const ecs::entity& e : entities ) {
+                REQUIRE(e.get_component<position_c>() == position_c(1, 2));
+                REQUIRE(e.get_component<velocity_c>() == velocity_c(3, 4));
+            }
+        }
+        {
+            ecs::registry w;
+
+            auto proto_e = w.create_entity();
+            proto_e.assign_component<position_c>(5, 6);
+            proto_e.assign_component<movable_c>();
+
+            std::vector<ecs::entity> clones;
+            w.clone_n(proto_e, 10u, std::back_inserter(clones));
+
+            REQUIRE(clones.size() == 10u);
+            REQUIRE(w.component_count<position_c>() == 11u);
+            REQUIRE(w.component_count<movable_c>() == 11u);
+            for ( const ecs::entity& e : clones ) {
+                REQUIRE(e.get_component<position_c>() == position_c(5, 6));
+                REQUIRE(e.exists_component<movable_c>());
+            }
+
+            // cloned entities land in owned group partitions
+            auto& g = w.group<position_c, movable_c>();
+            std::size_t group_count = 0u;
+            g.for_joined_components([&group_count](
+                const ecs::entity&, const position_c&, const movable_c&)
+            {
+                ++group_count;
+            });
+            REQUIRE(group_count == 11u);
+
+            std::vector<ecs::entity> more_clones;
+            w.clone_n(proto_e, 5u, std::back_inserter(more_clones));
+
+            group_count = 0u;
+            g.for_joined_components([&group_count](
+                const ecs::entity&, const position_c&, const movable_c&)
+            {
+                ++group_count;
+            });
+            REQUIRE(group_count == 16u);
+        }
+    }
+    SECTION("reserve_capacity") {
+        {
+            ecs::registry w;
+            REQUIRE(w.entity_capacity() == 0u);
+
+            w.reserve_entities(100u);
+            const std::size_t reserved = w.entity_capacity();
+            REQUIRE(reserved >= 100u);
+
+            std::vector<ecs::entity> entities;
+            w.create_entities(100u, std::back_inserter(entities));
+            REQUIRE(w.entity_capacity() == reserved);
+        }
+        {
+            ecs::registry w;
+            REQUIRE(w.component_capacity<position_c>() == 0u);
+
+            w.reserve<position_c>(64u);
+            const std::size_t reserved = w.component_capacity<position_c>();
+            REQUIRE(reserved >= 64u);
+
+            for ( std::size_t i = 0; i < 64u; ++i ) {
+                w.create_entity().assign_component<position_c>(1, 2);
+            }
+            REQUIRE(w.component_capacity<position_c>() == reserved);
+            REQUIRE(w.component_capacity<velocity_c>() == 0u);
+
+            w.reserve<movable_c>(32u);
+            REQUIRE(w.component_capacity<movable_c>() >= 32u);
+        }
+    }
+    SECTION("signatures") {
+        {
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            REQUIRE_FALSE(e1.exists_component<position_c>());
+
+            e1.assign_component<position_c>(1, 2);
+            REQUIRE(e1.exists_component<position_c>());
+            REQUIRE_FALSE(e1.exists_component<velocity_c>());
+
+            e1.remove_component<position_c>();
+            REQUIRE_FALSE(e1.exists_component<position_c>());
+
+            // cloned entities inherit the component mask
+            e1.assign_component<position_c>(1, 2);
+            e1.assign_component<movable_c>();
+            auto e2 = w.create_entity(e1);
+            REQUIRE(e2.exists_component<position_c>());
+            REQUIRE(e2.exists_component<movable_c>());
+            REQUIRE_FALSE(e2.exists_component<velocity_c>());
+
+            // clearing a whole storage clears every mask bit
+            w.remove_all_components<position_c>();
+            REQUIRE_FALSE(e1.exists_component<position_c>());
+            REQUIRE_FALSE(e2.exists_component<position_c>());
+            REQUIRE(e1.exists_component<movable_c>());
+            REQUIRE(e2.exists_component<movable_c>());
+        }
+        {
+            // recycled entity indices start with an empty mask
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+            e1.destroy();
+
+            auto e2 = w.create_entity();
+            REQUIRE_FALSE(e2.exists_component<position_c>());
+        }
+    }
+    SECTION("snapshots") {
+        std::vector<unsigned char> buffer;
+        const auto writer = [&buffer](const void* data, std::size_t size){
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        };
+
+        {
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+            e1.assign_component<movable_c>();
+
+            auto e2 = w.create_entity();
+            e2.assign_component<position_c>(3, 4);
+            e2.assign_component<velocity_c>(5, 6);
+
+            // a destroyed entity keeps its index in the free list
+            w.create_entity().destroy();
+
+            w.snapshot<position_c, velocity_c, movable_c>(writer);
+        }
+
+        std::size_t offset = 0u;
+        const auto reader = [&buffer, &offset](void* data, std::size_t size){
+            REQUIRE(offset + size <= buffer.size());
+            std::memcpy(data, buffer.data() + offset, size);
+            offset += size;
+        };
+
+        {
+            ecs::registry w;
+
+            // restore drops any current world state
+            w.create_entity().assign_component<position_c>(100, 200);
+
+            w.restore<position_c, velocity_c, movable_c>(reader);
+            REQUIRE(offset == buffer.size());
+
+            REQUIRE(w.entity_count() == 2u);
+            REQUIRE(w.component_count<position_c>() == 2u);
+            REQUIRE(w.component_count<velocity_c>() == 1u);
+            REQUIRE(w.component_count<movable_c>() == 1u);
+
+            std::size_t joined_count = 0u;
+            w.for_joined_components<position_c, velocity_c>([&joined_count](
+                const ecs::entity&, const position_c& p, const velocity_c& v)
+            {
+                ++joined_count;
+                REQUIRE(p == position_c(3, 4));
+                REQUIRE(v == velocity_c(5, 6));
+            });
+            REQUIRE(joined_count == 1u);
+
+            // the free list survives the round trip,
+            // so new entities recycle pre-snapshot indices
+            auto e4 = w.create_entity();
+            REQUIRE(w.entity_count() == 3u);
+            REQUIRE(e4.valid());
+        }
+    }
+    SECTION("change_tracking") {
+        {
+            ecs::registry w;
+            w.track_changes<position_c>();
+
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+            e2.assign_component<position_c>(3, 4);
+
+            std::size_t changed_count = 0u;
+            w.for_changed_components<position_c>([&changed_count](
+                const ecs::entity&, position_c&)
+            {
+                ++changed_count;
+            });
+            REQUIRE(changed_count == 2u);
+
+            // the dirty list is cleared after iteration
+            changed_count = 0u;
+            w.for_changed_components<position_c>([&changed_count](
+                const ecs::entity&, position_c&)
+            {
+                ++changed_count;
+            });
+            REQUIRE(changed_count == 0u);
+
+            // patching marks only the touched entity
+            e1.patch_component<position_c>([](position_c& p){
+                p.x = 10;
+            });
+            REQUIRE(e1.get_component<position_c>() == position_c(10, 2));
+
+            w.for_changed_components<position_c>([&changed_count, &e1](
+                const ecs::entity& e, position_c& p)
+            {
+                ++changed_count;
+                REQUIRE(e == e1);
+                REQUIRE(p == position_c(10, 2));
+            });
+            REQUIRE(changed_count == 1u);
+
+            // plain reads and writes through get_component are not tracked
+            e1.get_component<position_c>().y = 20;
+            changed_count = 0u;
+            w.for_changed_components<position_c>([&changed_count](
+                const ecs::entity&, position_c&)
+            {
+                ++changed_count;
+            });
+            REQUIRE(changed_count == 0u);
+        }
+        {
+            // removed entities leave the dirty list
+            ecs::registry w;
+            w.track_changes<position_c>();
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+            e1.remove_component<position_c>();
+
+            std::size_t changed_count = 0u;
+            w.for_changed_components<position_c>([&changed_count](
+                const ecs::entity&, position_c&)
+            {
+                ++changed_count;
+            });
+            REQUIRE(changed_count == 0u);
+        }
+        {
+            // tracking is opt-in per storage
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+
+            std::size_t changed_count = 0u;
+            w.for_changed_components<position_c>([&changed_count](
+                const ecs::entity&, position_c&)
+            {
+                ++changed_count;
+            });
+            REQUIRE(changed_count == 0u);
+
+            w.track_changes<position_c>();
+            e1.ensure_component<position_c>(1, 2);
+            w.for_changed_components<position_c>([&changed_count](
+                const ecs::entity&, position_c&)
+            {
+                ++changed_count;
+            });
+            REQUIRE(changed_count == 0u);
+
+            e1.assign_component<position_c>(5, 6);
+            w.for_changed_components<position_c>([&changed_count](
+                const ecs::entity&, position_c&)
+            {
+                ++changed_count;
+            });
+            REQUIRE(changed_count == 1u);
+        }
+    }
+    SECTION("sorting") {
+        {
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+            auto e3 = w.create_entity();
+
+            e1.assign_component<position_c>(3, 0);
+            e2.assign_component<position_c>(1, 0);
+            e3.assign_component<position_c>(2, 0);
+
+            w.sort<position_c>([](const position_c& l, const position_c& r){
+                return l.x < r.x;
+            });
+
+            {
+                std::vector<int> xs;
+                w.for_each_component<position_c>([&xs](
+                    const ecs::entity&, const position_c& p)
+                {
+                    xs.push_back(p.x);
+                });
+                REQUIRE(xs == std::vector<int>{1, 2, 3});
+            }
+
+            // sparse lookups survive the reorder
+            REQUIRE(e1.get_component<position_c>() == position_c(3, 0));
+            REQUIRE(e2.get_component<position_c>() == position_c(1, 0));
+            REQUIRE(e3.get_component<position_c>() == position_c(2, 0));
+        }
+        {
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+            auto e3 = w.create_entity();
+
+            e1.assign_component<position_c>(3, 0);
+            e2.assign_component<position_c>(1, 0);
+            e3.assign_component<position_c>(2, 0);
+
+            e1.assign_component<velocity_c>(30, 0);
+            e3.assign_component<velocity_c>(20, 0);
+
+            w.sort<position_c>([](const position_c& l, const position_c& r){
+                return l.x < r.x;
+            });
+            w.sort_as<velocity_c, position_c>();
+
+            // velocity follows position's dense order for common entities
+            std::vector<int> xs;
+            w.for_each_component<velocity_c>([&xs](
+                const ecs::entity&, const velocity_c& v)
+            {
+                xs.push_back(v.x);
+            });
+            REQUIRE(xs == std::vector<int>{20, 30});
+        }
+        {
+            // group owned storages can't be reordered from outside
+            ecs::registry w;
+            w.group<position_c, velocity_c>();
+            REQUIRE_THROWS_AS(
+                w.sort<position_c>([](const position_c& l, const position_c& r){
+                    return l.x < r.x;
+                }),
+                std::logic_error);
+        }
+    }
+    SECTION("stable_storage") {
+        {
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+            auto e3 = w.create_entity();
+            auto e4 = w.create_entity();
+
+            e1.assign_component<stable_c>(1);
+            e2.assign_component<stable_c>(2);
+            e3.assign_component<stable_c>(3);
+            e4.assign_component<stable_c>(4);
+
+            e2.remove_component<stable_c>();
+
+            // stable storages keep the creation order on removes
+            std::vector<int> is;
+            w.for_each_component<stable_c>([&is](
+                const ecs::entity&, const stable_c& c)
+            {
+                is.push_back(c.i);
+            });
+            REQUIRE(is == std::vector<int>{1, 3, 4});
+
+            // sparse lookups survive the shift
+            REQUIRE(e1.get_component<stable_c>().i == 1);
+            REQUIRE(e3.get_component<stable_c>().i == 3);
+            REQUIRE(e4.get_component<stable_c>().i == 4);
+            REQUIRE_FALSE(e2.exists_component<stable_c>());
+        }
+        {
+            // the default policy swap-and-pops
+            ecs::registry w;
+
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+            auto e3 = w.create_entity();
+
+            e1.assign_component<position_c>(1, 0);
+            e2.assign_component<position_c>(2, 0);
+            e3.assign_component<position_c>(3, 0);
+
+            e1.remove_component<position_c>();
+
+            std::vector<int> xs;
+            w.for_each_component<position_c>([&xs](
+                const ecs::entity&, const position_c& p)
+            {
+                xs.push_back(p.x);
+            });
+            REQUIRE(xs == std::vector<int>{3, 2});
+        }
+    }
+    SECTION("batch_insert") {
+        {
+            ecs::registry w;
+
+            std::vector<ecs::entity> ents;
+            w.create_entities(3u, std::back_inserter(ents));
+
+            std::vector<ecs::entity_id> ids;
+            for ( const ecs::entity& e : ents ) {
+                ids.push_back(e.id());
+            }
+
+            const std::array<position_c, 3> ps{
+                position_c(1, 2),
+                position_c(3, 4),
+                position_c(5, 6)};
+            w.insert<position_c>(ids.begin(), ids.end(), ps.data());
+
+            REQUIRE(w.component_count<position_c>() == 3u);
+            for ( std::size_t i = 0; i < ids.size(); ++i ) {
+                REQUIRE(w.get_component<position_c>(ids[i]) == ps[i]);
+            }
+
+            // the fill overload assigns the same value everywhere
+            w.insert<velocity_c>(ids.begin(), ids.end(), velocity_c(7, 8));
+            REQUIRE(w.component_count<velocity_c>() == 3u);
+
+            // signatures are updated, so joins see the new components
+            std::size_t joined = 0u;
+            w.for_joined_components<position_c, velocity_c>([&joined](
+                const ecs::entity&, const position_c&, const velocity_c& v)
+            {
+                ++joined;
+                REQUIRE(v == velocity_c(7, 8));
+            });
+            REQUIRE(joined == 3u);
+
+            // empty components batch through the fill overload too
+            w.insert<movable_c>(ids.begin(), ids.end(), movable_c{});
+            REQUIRE(w.component_count<movable_c>() == 3u);
+        }
+        {
+            // construct signals fire for every batched component
+            ecs::registry w;
+
+            std::size_t constructed = 0u;
+            w.on_construct<position_c>([&constructed](
+                const ecs::entity&, position_c&)
+            {
+                ++constructed;
+            });
+
+            std::vector<ecs::entity> ents;
+            w.create_entities(4u, std::back_inserter(ents));
+
+            std::vector<ecs::entity_id> ids;
+            for ( const ecs::entity& e : ents ) {
+                ids.push_back(e.id());
+            }
+
+            w.insert<position_c>(ids.begin(), ids.end(), position_c(1, 2));
+            REQUIRE(constructed == 4u);
+        }
+    }
+    SECTION("emplace_components") {
+        struct name_c {
+            std::string value;
+            name_c(std::size_t count, char ch)
+            : value(count, ch) {}
+            name_c(std::string nv)
+            : value(std::move(nv)) {}
+        };
+        {
+            // emplace constructs in the storage slot with the
+            // component constructor arguments, no temporary component
+            ecs::registry w;
+            auto e1 = w.create_entity();
+
+            name_c& n = e1.emplace_component<name_c>(std::size_t(3), 'a');
+            REQUIRE(n.value == "aaa");
+            REQUIRE(e1.exists_component<name_c>());
+
+            // re-emplacing replaces the existing component
+            e1.emplace_component<name_c>(std::size_t(2), 'b');
+            REQUIRE(e1.get_component<name_c>().value == "bb");
+
+            // empty components emplace too
+            e1.emplace_component<movable_c>();
+            REQUIRE(e1.exists_component<movable_c>());
+        }
+        {
+            // a moved-in value passes through assignment untouched
+            ecs::registry w;
+            auto e1 = w.create_entity();
+
+            std::string payload(64, 'x');
+            const char* payload_data = payload.data();
+            e1.assign_component<name_c>(name_c{std::move(payload)});
+            REQUIRE(e1.get_component<name_c>().value.data() == payload_data);
+
+            std::string new_payload(64, 'y');
+            const char* new_payload_data = new_payload.data();
+            e1.assign_component<name_c>(name_c{std::move(new_payload)});
+            REQUIRE(e1.get_component<name_c>().value.data() == new_payload_data);
+        }
+        {
+            // construct signals fire for emplaced components as well
+            ecs::registry w;
+
+            std::size_t constructed = 0u;
+            w.on_construct<position_c>([&constructed](
+                const ecs::entity&, position_c&)
+            {
+                ++constructed;
+            });
+
+            auto e1 = w.create_entity();
+            e1.emplace_component<position_c>(1, 2);
+            REQUIRE(constructed == 1u);
+            e1.emplace_component<position_c>(3, 4);
+            REQUIRE(constructed == 1u);
+        }
+    }
+    SECTION("move_entity") {
+        {
+            ecs::registry src;
+            ecs::registry dst;
+
+            auto e1 = src.create_entity();
+            ecs::entity_filler(e1)
+                .component<position_c>(1, 2)
+                .component<velocity_c>(3, 4)
+                .component<movable_c>();
+
+            auto e2 = src.move_entity(e1, dst);
+
+            REQUIRE_FALSE(src.valid_entity(e1));
+            REQUIRE(src.entity_count() == 0u);
+            REQUIRE(src.component_count<position_c>() == 0u);
+
+            REQUIRE(dst.valid_entity(e2));
+            REQUIRE(e2.get_component<position_c>() == position_c(1, 2));
+            REQUIRE(e2.get_component<velocity_c>() == velocity_c(3, 4));
+            REQUIRE(e2.exists_component<movable_c>());
+
+            // the moved entity joins like any native one
+            std::size_t joined = 0u;
+            dst.for_joined_components<position_c, velocity_c>([&joined](
+                const ecs::entity&, const position_c&, const velocity_c&)
+            {
+                ++joined;
+            });
+            REQUIRE(joined == 1u);
+        }
+        {
+            // construct signals fire in the destination,
+            // destroy signals fire in the source
+            ecs::registry src;
+            ecs::registry dst;
+
+            std::size_t constructed = 0u;
+            dst.on_construct<position_c>([&constructed](
+                const ecs::entity&, position_c&)
+            {
+                ++constructed;
+            });
+
+            std::size_t destroyed = 0u;
+            src.on_destroy<position_c>([&destroyed](const ecs::entity&){
+                ++destroyed;
+            });
+
+            auto e1 = src.create_entity();
+            e1.assign_component<position_c>(1, 2);
+
+            src.move_entity(e1, dst);
+            REQUIRE(constructed == 1u);
+            REQUIRE(destroyed == 1u);
+        }
+    }
+#if defined(ECS_HPP_ENABLE_STATS)
+    SECTION("stats") {
+        struct update_evt {};
+
+        class slow_system : public ecs::system<update_evt> {
+        public:
+            void process(ecs::registry& owner, const update_evt&) override {
+                owner.for_joined_components<position_c, velocity_c>([](
+                    const ecs::entity&, position_c& p, const velocity_c& v)
+                {
+                    p.x += v.x;
+                });
+            }
+        };
+
+        ecs::registry w;
+        REQUIRE(w.stats().component_inserts == 0u);
+
+        auto e1 = w.create_entity();
+        auto e2 = w.create_entity();
+        e1.assign_component<position_c>(1, 2);
+        e2.assign_component<position_c>(3, 4);
+        e1.assign_component<velocity_c>(5, 6);
+
+        {
+            const auto s = w.stats();
+            REQUIRE(s.component_inserts == 3u);
+            REQUIRE(s.component_erases == 0u);
+        }
+
+        // probing a missing component counts as a miss
+        REQUIRE_FALSE(e2.find_component<velocity_c>());
+        REQUIRE(w.stats().component_probe_misses > 0u);
+
+        // joins count visited vs matched entities;
+        // the smallest storage leads, so make position the lead
+        auto e3 = w.create_entity();
+        auto e4 = w.create_entity();
+        e3.assign_component<velocity_c>(0, 0);
+        e4.assign_component<velocity_c>(0, 0);
+
+        w.for_joined_components<position_c, velocity_c>([](
+            const ecs::entity&, const position_c&, const velocity_c&)
+        {
+        });
+        {
+            const auto s = w.stats();
+            REQUIRE(s.join_entities_visited == 2u);
+            REQUIRE(s.join_entities_matched == 1u);
+        }
+
+        e1.remove_component<velocity_c>();
+        REQUIRE(w.stats().component_erases == 1u);
+
+        // per-system wall time is accumulated by system index
+        auto& f = w.assign_feature<struct stats_feature>()
+            .add_system<slow_system>()
+            .add_system<slow_system>();
+        w.process_event(update_evt{});
+
+        const auto times = f.system_times();
+        REQUIRE(times.size() == 2u);
+        REQUIRE(times[0] >= 0.0);
+        REQUIRE(times[1] >= 0.0);
+
+        w.reset_stats();
+        {
+            const auto s = w.stats();
+            REQUIRE(s.component_inserts == 0u);
+            REQUIRE(s.component_erases == 0u);
+            REQUIRE(s.component_probe_misses == 0u);
+            REQUIRE(s.join_entities_visited == 0u);
+            REQUIRE(s.join_entities_matched == 0u);
+        }
+        REQUIRE(f.system_times() == std::vector<double>(2u, 0.0));
+    }
+#endif
+    SECTION("raw_views") {
+        {
+            ecs::registry w;
+
+            REQUIRE(w.raw_view<position_c>().empty());
+            REQUIRE(std::as_const(w).raw_view<position_c>().empty());
+
+            auto e1 = w.create_entity();
+            auto e2 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+            e2.assign_component<position_c>(3, 4);
+
+            auto rv = w.raw_view<position_c>();
+            REQUIRE_FALSE(rv.empty());
+            REQUIRE(rv.size() == 2u);
+            REQUIRE(rv.ids()[0] == e1.id());
+            REQUIRE(rv.ids()[1] == e2.id());
+
+            // the span aliases the dense storage, writes are visible
+            for ( std::size_t i = 0; i < rv.size(); ++i ) {
+                rv.components()[i].x *= 10;
+            }
+            REQUIRE(e1.get_component<position_c>() == position_c(10, 2));
+            REQUIRE(e2.get_component<position_c>() == position_c(30, 4));
+
+            auto crv = std::as_const(w).raw_view<position_c>();
+            REQUIRE(crv.size() == 2u);
+            REQUIRE(crv.components()[1] == position_c(30, 4));
+        }
+    }
+    SECTION("signals") {
+        {
+            ecs::registry w;
+
+            std::size_t constructed = 0u;
+            std::size_t destroyed = 0u;
+
+            w.on_construct<position_c>([&constructed](
+                const ecs::entity&, position_c& p)
+            {
+                ++constructed;
+                REQUIRE(p == position_c(1, 2));
+            });
+            w.on_destroy<position_c>([&destroyed](const ecs::entity&){
+                ++destroyed;
+            });
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+            REQUIRE(constructed == 1u);
+
+            // overwriting assigns are not constructions
+            e1.assign_component<position_c>(1, 2);
+            REQUIRE(constructed == 1u);
+            e1.ensure_component<position_c>(3, 4);
+            REQUIRE(constructed == 1u);
+
+            e1.remove_component<position_c>();
+            REQUIRE(destroyed == 1u);
+
+            e1.assign_component<position_c>(1, 2);
+            REQUIRE(constructed == 2u);
+            e1.destroy();
+            REQUIRE(destroyed == 2u);
+        }
+        {
+            // cloned entities emit construct signals too
+            ecs::registry w;
+
+            std::size_t constructed = 0u;
+            w.on_construct<position_c>([&constructed](
+                const ecs::entity&, position_c&)
+            {
+                ++constructed;
+            });
+
+            auto proto_e = w.create_entity();
+            proto_e.assign_component<position_c>(1, 2);
+            REQUIRE(constructed == 1u);
+
+            w.create_entity(proto_e);
+            REQUIRE(constructed == 2u);
+        }
+        {
+            // batched delivery queues signals until the next flush
+            ecs::registry w;
+            w.batch_signals();
+
+            std::size_t constructed = 0u;
+            std::size_t destroyed = 0u;
+            w.on_construct<position_c>([&constructed](
+                const ecs::entity&, position_c&)
+            {
+                ++constructed;
+            });
+            w.on_destroy<velocity_c>([&destroyed](const ecs::entity&){
+                ++destroyed;
+            });
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(1, 2);
+            e1.assign_component<velocity_c>(3, 4);
+            e1.remove_component<velocity_c>();
+            REQUIRE(constructed == 0u);
+            REQUIRE(destroyed == 0u);
+
+            w.flush_signals();
+            REQUIRE(constructed == 1u);
+            REQUIRE(destroyed == 1u);
+
+            // process_event flushes pending signals first
+            struct update_event {};
+            e1.assign_component<velocity_c>(3, 4);
+            e1.remove_component<velocity_c>();
+            w.process_event(update_event{});
+            REQUIRE(destroyed == 2u);
+        }
+    }
+    SECTION("aspects") {
+        {
+            using empty_aspect = ecs::aspect<>;
+
+            ecs::registry w;
+
+            ecs::entity e1 = w.create_entity();
+            REQUIRE(empty_aspect::match_entity(e1));
+
+            ecs::entity e2 = w.create_entity();
+            e2.assign_component<movable_c>();
+            e2.assign_component<position_c>(1,2);
+            REQUIRE(empty_aspect::match_entity(e2));
+
+            ecs::entity e3 = w.create_entity();
+            e3.assign_component<movable_c>();
+            e3.assign_component<position_c>(1,2);
+            e3.assign_component<velocity_c>(3,4);
+            REQUIRE(empty_aspect::match_entity(e3));
+
+            {
+                ecs::entity_id acc{};
+                empty_aspect::for_each_entity(w, [&acc](ecs::entity e){
+                    acc += e.id();
+                }, ecs::exists<movable_c>{});
+                REQUIRE(acc == e2.id() + e3.id());
+            }
+
+            {
+                ecs::entity_id acc{};
+                empty_aspect::for_joined_components(w, [&acc](ecs::entity e){
+                    acc += e.id();
+                }, ecs::exists<movable_c>{});
+                REQUIRE(acc == e2.id() + e3.id());
+            }
+
+            {
+                ecs::entity_id acc{};
+                w.for_each_entity([&acc](ecs::entity e){
+                    acc += e.id();
+                }, empty_aspect::to_option());
+                REQUIRE(acc == e1.id() + e2.id() + e3.id());
+            }
+        }
+        {
+            using movable = ecs::aspect<
+                position_c,
+                velocity_c>;
+
+            ecs::registry w;
+
+            ecs::entity e = w.create_entity();
+            REQUIRE_FALSE(movable::match_entity(e));
+
+            e.assign_component<position_c>(1,2);
+            REQUIRE_FALSE(movable::match_entity(e));
+
+            e.assign_component<velocity_c>(3,4);
+            REQUIRE(movable::match_entity(e));
+
+            ecs::entity e2 = w.create_entity();
+            e2.assign_component<position_c>(1,2);
+
+            movable::for_joined_components(w,
+            [](ecs::entity_id, position_c& p, const velocity_c& v){
+                p.x += v.x;
+                p.y += v.y;
+            });
+
+            movable::for_joined_components(std::as_const(w),
+            [](ecs::entity_id, const position_c& p, const velocity_c& v){
+                const_cast<position_c&>(p).x += v.x;
+                const_cast<position_c&>(p).y += v.y;
+            });
+
+            w.for_each_entity([](ecs::entity e){
+                auto& p = e.get_component<position_c>();
+                const auto& v = e.get_component<velocity_c>();
+                p.x += v.x;
+                p.y += v.y;
+            }, movable::to_option());
+
+            std::as_const(w).for_each_entity([](const ecs::const_entity& e){
+                const auto& p = e.get_component<position_c>();
+                const auto& v = e.get_component<velocity_c>();
+                const_cast<position_c&>(p).x += v.x;
+                const_cast<position_c&>(p).y += v.y;
+            }, movable::to_option());
+
+            REQUIRE(e.get_component<position_c>().x == 1 + 3*4);
+            REQUIRE(e.get_component<position_c>().y == 2 + 4*4);
+
+            REQUIRE(e2.get_component<position_c>().x == 1);
+            REQUIRE(e2.get_component<position_c>().y == 2);
+        }
+        {
+            using movable = ecs::aspect<
+                position_c,
+                velocity_c>;
+
+            ecs::registry w;
+            const ecs::compiled_aspect<position_c, velocity_c> ca{w};
+
+            auto e1 = w.create_entity();
+            REQUIRE_FALSE(ca.match_entity(e1.id()));
+            REQUIRE(ca.count() == 0u);
+            REQUIRE(movable::count(w) == 0u);
+
+            e1.assign_component<position_c>(1, 2);
+            REQUIRE_FALSE(ca.match_entity(e1.id()));
+
+            e1.assign_component<velocity_c>(3, 4);
+            REQUIRE(ca.match_entity(e1.id()));
+
+            auto e2 = w.create_entity();
+            e2.assign_component<position_c>(1, 2);
+            auto e3 = w.create_entity();
+            ecs::entity_filler(e3)
+                .component<position_c>(5, 6)
+                .component<velocity_c>(7, 8);
+
+            REQUIRE(ca.count() == 2u);
+            REQUIRE(movable::count(w) == 2u);
+
+            e1.remove_component<velocity_c>();
+            REQUIRE_FALSE(ca.match_entity(e1.id()));
+            REQUIRE(ca.count() == 1u);
+
+            // a recycled entity index doesn't match through stale ids
+            const ecs::entity_id e3_id = e3.id();
+            e3.destroy();
+            auto e4 = w.create_entity();
+            e4.assign_component<position_c>(0, 0);
+            e4.assign_component<velocity_c>(0, 0);
+            REQUIRE(ca.match_entity(e4.id()));
+            REQUIRE_FALSE(ca.match_entity(e3_id));
+        }
+    }
+    SECTION("options") {
+        {
+            ecs::registry w;
+
+            auto e = w.create_entity();
+
+            REQUIRE((!ecs::exists<position_c>{})(e));
+            REQUIRE((!ecs::exists<velocity_c>{})(e));
+
+            REQUIRE((!ecs::exists_any<>{})(e));
+            REQUIRE((!ecs::exists_any<position_c>{})(e));
+            REQUIRE((!ecs::exists_any<velocity_c>{})(e));
+            REQUIRE((!ecs::exists_any<position_c, velocity_c>{})(e));
+
+            REQUIRE_FALSE((!ecs::exists_all<>{})(e));
+            REQUIRE((!ecs::exists_all<position_c>{})(e));
+            REQUIRE((!ecs::exists_all<velocity_c>{})(e));
+            REQUIRE((!ecs::exists_all<position_c, velocity_c>{})(e));
+
+            e.assign_component<position_c>();
+
+            REQUIRE_FALSE((!ecs::exists<position_c>{})(e));
+            REQUIRE((!ecs::exists<velocity_c>{})(e));
+
+            REQUIRE((!ecs::exists_any<>{})(e));
+            REQUIRE_FALSE((!ecs::exists_any<position_c>{})(e));
+            REQUIRE((!ecs::exists_any<velocity_c>{})(e));
+            REQUIRE_FALSE((!ecs::exists_any<position_c, velocity_c>{})(e));
+
+            REQUIRE_FALSE((!ecs::exists_all<>{})(e));
+            REQUIRE_FALSE((!ecs::exists_all<position_c>{})(e));
+            REQUIRE((!ecs::exists_all<velocity_c>{})(e));
+            REQUIRE((!ecs::exists_all<position_c, velocity_c>{})(e));
+
+            e.assign_component<velocity_c>();
 
             REQUIRE_FALSE((!ecs::exists<position_c>{})(e));
             REQUIRE_FALSE((!ecs::exists<velocity_c>{})(e));
@@ -1604,6 +3077,238 @@ TEST_CASE("registry") {
 
         REQUIRE(w.component_count<velocity_c>() == 0);
     }
+    SECTION("batched_events") {
+        struct update_evt {
+            int dt{};
+        };
+
+        class counting_system : public ecs::system<update_evt> {
+        public:
+            counting_system(int& acc)
+            : acc_(acc) {}
+
+            void process(ecs::registry&, const update_evt& evt) override {
+                acc_ += evt.dt;
+            }
+        private:
+            int& acc_;
+        };
+
+        int acc = 0;
+        ecs::registry w;
+        w.assign_feature<struct physics>()
+            .add_system<counting_system>(acc);
+
+        const std::array<update_evt, 3> events{{{1}, {2}, {3}}};
+        w.process_events(events.begin(), events.end());
+        REQUIRE(acc == 6);
+
+        // systems added after the first dispatch are picked up too
+        w.get_feature<struct physics>()
+            .add_system<counting_system>(acc);
+
+        w.process_event(update_evt{10});
+        REQUIRE(acc == 26);
+    }
+    SECTION("event_queue") {
+        struct damage_evt {
+            int amount{};
+        };
+
+        struct death_evt {
+            int total{};
+        };
+
+        class damage_system : public ecs::system<damage_evt> {
+        public:
+            damage_system(int& acc, int& batches)
+            : acc_(acc)
+            , batches_(batches) {}
+
+            void process(ecs::registry&, const damage_evt& evt) override {
+                acc_ += evt.amount;
+            }
+
+            void process_batch(
+                ecs::registry& owner,
+                const damage_evt* events,
+                std::size_t event_count) override
+            {
+                ++batches_;
+                int total = 0;
+                for ( std::size_t i = 0; i < event_count; ++i ) {
+                    total += events[i].amount;
+                }
+                acc_ += total;
+                // follow-up events join the next dispatch pass
+                owner.enqueue_event(death_evt{total});
+            }
+        private:
+            int& acc_;
+            int& batches_;
+        };
+
+        class death_system : public ecs::system<death_evt> {
+        public:
+            death_system(int& deaths)
+            : deaths_(deaths) {}
+
+            void process(ecs::registry&, const death_evt& evt) override {
+                deaths_ += evt.total;
+            }
+        private:
+            int& deaths_;
+        };
+
+        class trigger_system : public ecs::system<ecs::before<damage_evt>> {
+        public:
+            trigger_system(int& befores)
+            : befores_(befores) {}
+
+            void process(ecs::registry&, const ecs::before<damage_evt>&) override {
+                ++befores_;
+            }
+        private:
+            int& befores_;
+        };
+
+        int acc = 0;
+        int batches = 0;
+        int deaths = 0;
+        int befores = 0;
+
+        ecs::registry w;
+        w.assign_feature<struct combat>()
+            .add_system<damage_system>(acc, batches)
+            .add_system<death_system>(deaths)
+            .add_system<trigger_system>(befores);
+
+        w.enqueue_event(damage_evt{1});
+        w.enqueue_event(damage_evt{2});
+        w.enqueue_event(damage_evt{3});
+
+        // nothing runs until the dispatch
+        REQUIRE(acc == 0);
+
+        w.dispatch_events();
+
+        // one batch for the damage queue, befores still fire per event,
+        // and the follow-up death event was handled in the next pass
+        REQUIRE(acc == 6);
+        REQUIRE(batches == 1);
+        REQUIRE(befores == 3);
+        REQUIRE(deaths == 6);
+
+        // the default process_batch forwards every event to process()
+        int plain_acc = 0;
+        ecs::registry w2;
+        w2.assign_feature<struct combat>()
+            .add_system<death_system>(plain_acc);
+        w2.enqueue_event(death_evt{4});
+        w2.enqueue_event(death_evt{5});
+        w2.dispatch_events();
+        REQUIRE(plain_acc == 9);
+    }
+    SECTION("parallel_systems") {
+        struct update_evt {};
+
+        class add_system : public ecs::system<update_evt> {
+        public:
+            add_system(int n) : n_(n) {}
+
+            ecs::system_access access() const override {
+                return ecs::system_access{}.write<position_c>();
+            }
+
+            void process(ecs::registry& owner, const update_evt&) override {
+                owner.for_each_component<position_c>([this](
+                    ecs::entity, position_c& p)
+                {
+                    p.x += n_;
+                });
+            }
+        private:
+            int n_{};
+        };
+
+        class mul_system : public ecs::system<update_evt> {
+        public:
+            ecs::system_access access() const override {
+                return ecs::system_access{}.write<position_c>();
+            }
+
+            void process(ecs::registry& owner, const update_evt&) override {
+                owner.for_each_component<position_c>([](
+                    ecs::entity, position_c& p)
+                {
+                    p.x *= 2;
+                });
+            }
+        };
+
+        class velocity_system : public ecs::system<update_evt> {
+        public:
+            ecs::system_access access() const override {
+                return ecs::system_access{}.write<velocity_c>();
+            }
+
+            void process(ecs::registry& owner, const update_evt&) override {
+                owner.for_each_component<velocity_c>([](
+                    ecs::entity, velocity_c& v)
+                {
+                    v.y += 1;
+                });
+            }
+        };
+
+        class undeclared_system : public ecs::system<update_evt> {
+        public:
+            undeclared_system(int& calls) : calls_(calls) {}
+
+            void process(ecs::registry&, const update_evt&) override {
+                ++calls_;
+            }
+        private:
+            int& calls_;
+        };
+
+        {
+            // conflicting systems keep their registration order
+            ecs::registry w;
+            w.assign_feature<struct physics>()
+                .add_system<add_system>(5)
+                .add_system<mul_system>()
+                .add_system<velocity_system>();
+
+            auto e1 = w.create_entity();
+            e1.assign_component<position_c>(0, 0);
+            e1.assign_component<velocity_c>(0, 0);
+
+            thread_executor executor;
+            w.process_event_par(executor, update_evt{});
+
+            REQUIRE(e1.get_component<position_c>().x == 10);
+            REQUIRE(e1.get_component<velocity_c>().y == 1);
+        }
+        {
+            // systems without declared access sets still run, sequentially
+            ecs::registry w;
+            int calls = 0;
+            w.assign_feature<struct physics>()
+                .add_system<undeclared_system>(calls)
+                .add_system<undeclared_system>(calls)
+                .add_system<velocity_system>();
+
+            auto e1 = w.create_entity();
+            e1.assign_component<velocity_c>(0, 0);
+
+            thread_executor executor;
+            w.process_event_par(executor, update_evt{});
+
+            REQUIRE(calls == 2);
+            REQUIRE(e1.get_component<velocity_c>().y == 1);
+        }
+    }
     SECTION("fillers") {
         struct component_n {
             int i = 0;
@@ -1646,6 +3351,9 @@ TEST_CASE("registry") {
         }
     }
     SECTION("memory_usage") {
+        const std::size_t page_usage =
+            sizeof(std::vector<std::uint32_t>) + // sparse page table entry
+            4096u * sizeof(std::uint32_t);       // one allocated sparse page
         {
             ecs::registry w;
             REQUIRE(w.memory_usage().entities == 0u);
@@ -1654,8 +3362,8 @@ TEST_CASE("registry") {
             auto e2 = w.create_entity();
 
             const std::size_t expected_usage =
-                2 * sizeof(ecs::entity_id) + // vector free entity ids
-                4 * sizeof(std::size_t) +    // sparse entity ids (keys)
+                2 * sizeof(ecs::entity_id) + // vector entity slots
+                page_usage +                 // sparse entity ids (keys)
                 2 * sizeof(ecs::entity_id);  // sparse entity ids (values)
             REQUIRE(w.memory_usage().entities == expected_usage);
 
@@ -1678,13 +3386,13 @@ TEST_CASE("registry") {
 
             const std::size_t expected_usage =
                 2 * sizeof(position_c) +    // vector values
-                4 * sizeof(std::size_t) +   // sparse keys (keys)
+                page_usage +                // sparse keys (keys)
                 2 * sizeof(ecs::entity_id); // sparse keys (values)
             REQUIRE(w.memory_usage().components == expected_usage);
 
             REQUIRE(w.component_memory_usage<position_c>() ==
                 2 * sizeof(position_c) +
-                4 * sizeof(std::size_t) +
+                page_usage +
                 2 * sizeof(ecs::entity_id));
 
             REQUIRE_FALSE(w.component_memory_usage<velocity_c>());
@@ -1700,21 +3408,21 @@ TEST_CASE("registry") {
 
             const std::size_t expected_usage =
                 sizeof(position_c) +
-                2 * sizeof(std::size_t) +
+                page_usage +
                 1 * sizeof(ecs::entity_id) +
                 sizeof(velocity_c) +
-                3 * sizeof(std::size_t) +
+                page_usage +
                 1 * sizeof(ecs::entity_id);
             REQUIRE(w.memory_usage().components == expected_usage);
 
             REQUIRE(w.component_memory_usage<position_c>() ==
                 sizeof(position_c) +
-                2 * sizeof(std::size_t) +
+                page_usage +
                 1 * sizeof(ecs::entity_id));
 
             REQUIRE(w.component_memory_usage<velocity_c>() ==
                 sizeof(velocity_c) +
-                3 * sizeof(std::size_t) +
+                page_usage +
                 1 * sizeof(ecs::entity_id));
         }
         {
@@ -1724,7 +3432,7 @@ TEST_CASE("registry") {
             e1.assign_component<movable_c>();
             e2.assign_component<movable_c>();
             REQUIRE(w.component_memory_usage<movable_c>() ==
-                4 * sizeof(std::size_t) +
+                page_usage +
                 2 * sizeof(ecs::entity_id));
         }
     }
@@ -1742,3 +3450,100 @@ TEST_CASE("registry") {
         });
     }
 }
+
+TEST_CASE("registry_t") {
+    SECTION("entities") {
+        ecs::registry_t<ecs::components<position_c, velocity_c, movable_c>> w;
+        REQUIRE(w.entity_count() == 0u);
+
+        const auto e1 = w.create_entity();
+        const auto e2 = w.create_entity();
+        REQUIRE(w.entity_count() == 2u);
+        REQUIRE(w.valid_entity(e1));
+        REQUIRE(w.valid_entity(e2));
+
+        w.destroy_entity(e1);
+        REQUIRE(w.entity_count() == 1u);
+        REQUIRE_FALSE(w.valid_entity(e1));
+        REQUIRE(w.valid_entity(e2));
+    }
+    SECTION("components") {
+        ecs::registry_t<ecs::components<position_c, velocity_c, movable_c>> w;
+
+        const auto e1 = w.create_entity();
+        REQUIRE_FALSE(w.exists_component<position_c>(e1));
+        REQUIRE_FALSE(w.find_component<position_c>(e1));
+        REQUIRE_THROWS_AS(w.get_component<position_c>(e1), std::logic_error);
+
+        w.assign_component<position_c>(e1, 1, 2);
+        w.assign_component<movable_c>(e1);
+        REQUIRE(w.exists_component<position_c>(e1));
+        REQUIRE(w.exists_component<movable_c>(e1));
+        REQUIRE(w.get_component<position_c>(e1) == position_c(1, 2));
+        REQUIRE(w.component_count<position_c>() == 1u);
+
+        w.ensure_component<position_c>(e1, 3, 4);
+        REQUIRE(w.get_component<position_c>(e1) == position_c(1, 2));
+
+        REQUIRE(w.remove_component<position_c>(e1));
+        REQUIRE_FALSE(w.remove_component<position_c>(e1));
+        REQUIRE_FALSE(w.exists_component<position_c>(e1));
+
+        w.assign_component<position_c>(e1, 1, 2);
+        REQUIRE(w.remove_all_components(e1) == 2u);
+        REQUIRE_FALSE(w.exists_component<position_c>(e1));
+        REQUIRE_FALSE(w.exists_component<movable_c>(e1));
+    }
+    SECTION("clones") {
+        ecs::registry_t<ecs::components<position_c, velocity_c>> w;
+
+        const auto proto = w.create_entity();
+        w.assign_component<position_c>(proto, 1, 2);
+
+        const auto e1 = w.create_entity(proto);
+        REQUIRE(w.get_component<position_c>(e1) == position_c(1, 2));
+        REQUIRE_FALSE(w.exists_component<velocity_c>(e1));
+    }
+    SECTION("joins") {
+        ecs::registry_t<ecs::components<position_c, velocity_c>> w;
+
+        const auto e1 = w.create_entity();
+        w.assign_component<position_c>(e1, 1, 2);
+        w.assign_component<velocity_c>(e1, 3, 4);
+
+        const auto e2 = w.create_entity();
+        w.assign_component<position_c>(e2, 5, 6);
+
+        {
+            std::size_t count = 0u;
+            w.for_each_component<position_c>([&count](ecs::entity_id, position_c&){
+                ++count;
+            });
+            REQUIRE(count == 2u);
+        }
+
+        {
+            std::size_t count = 0u;
+            w.for_joined_components<position_c, velocity_c>([&count, e1](
+                ecs::entity_id e, position_c& p, velocity_c& v)
+            {
+                ++count;
+                REQUIRE(e == e1);
+                REQUIRE(p == position_c(1, 2));
+                REQUIRE(v == velocity_c(3, 4));
+            });
+            REQUIRE(count == 1u);
+        }
+
+        {
+            const auto& cw = w;
+            std::size_t count = 0u;
+            cw.for_joined_components<position_c, velocity_c>([&count](
+                ecs::entity_id, const position_c&, const velocity_c&)
+            {
+                ++count;
+            });
+            REQUIRE(count == 1u);
+        }
+    }
+}